@@ -0,0 +1,100 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file BlochTransformation.h
+ *  @brief Transforms a translation invariant real-space Model to k-space.
+ *
+ *  The real-space Model is a periodic lattice with Indices on the form
+ *  {x_1, ..., x_D, orbital...}, where the first D subindices are the lattice
+ *  coordinates and the remaining subindices identify the orbital within the
+ *  unit cell. The BlochTransformation extracts the hoppings from the Model
+ *  and verifies that they are invariant under lattice translations. It can
+ *  then create the equivalent block diagonal k-space Model with Indices on
+ *  the form {k_1, ..., k_D, orbital...} for an arbitrary k-mesh.
+ *
+ *  The real-space Model therefore only needs to be large enough to contain
+ *  each hopping once. The hopping displacements are taken to be the shortest
+ *  ones compatible with the periodic boundary conditions, which means that the
+ *  lattice size should be more than twice the hopping range.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef BLOCH_TRANSFORMATION
+#define BLOCH_TRANSFORMATION
+
+#include "TBTK/Model.h"
+
+#include <complex>
+#include <vector>
+
+class BlochTransformation{
+public:
+	/** Constructor.
+	 *
+	 *  @param model The translation invariant real-space Model.
+	 *  @param latticeSize The size of the lattice along each direction. */
+	BlochTransformation(
+		const TBTK::Model &model,
+		const std::vector<int> &latticeSize
+	);
+
+	/** Create the k-space Model.
+	 *
+	 *  @param kMeshSize The number of k-points along each direction.
+	 *
+	 *  @return The k-space Model. */
+	TBTK::Model createModel(const std::vector<int> &kMeshSize) const;
+
+	/** Create the part of the k-space Model with k-indices in the range
+	 *  [kxBegin, kxEnd) along the first direction.
+	 *
+	 *  @param kMeshSize The number of k-points along each direction.
+	 *  @param kxBegin The first k-index along the first direction.
+	 *  @param kxEnd One past the last k-index along the first direction.
+	 *
+	 *  @return The k-space Model. */
+	TBTK::Model createModel(
+		const std::vector<int> &kMeshSize,
+		int kxBegin,
+		int kxEnd
+	) const;
+private:
+	/** Hopping from one orbital to another orbital displaced by a given
+	 *  number of unit cells. */
+	class Hopping{
+	public:
+		std::vector<int> displacement;
+		std::vector<int> toOrbital;
+		std::vector<int> fromOrbital;
+		std::complex<double> amplitude;
+	};
+
+	/** The dimension of the lattice. */
+	unsigned int dimension;
+
+	/** Hoppings grouped by orbital pairs. Each group contains the hoppings
+	 *  between the same two orbitals. */
+	std::vector<std::vector<Hopping>> hoppings;
+};
+
+inline TBTK::Model BlochTransformation::createModel(
+	const std::vector<int> &kMeshSize
+) const{
+	return createModel(kMeshSize, 0, kMeshSize[0]);
+}
+
+#endif
@@ -0,0 +1,73 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file BlockAccumulator.h
+ *  @brief Base class for quantities that are accumulated block by block.
+ *
+ *  A BlockAccumulator that is added to a BlockSolver receives the eigenvalues
+ *  and eigenvectors of each block directly after the block has been solved.
+ *  To accumulate in parallel, the BlockSolver creates empty copies of the
+ *  BlockAccumulator that each accumulate a fixed range of consecutive blocks.
+ *  The copies are then merged into the original BlockAccumulator in the order
+ *  of the blocks.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef BLOCK_ACCUMULATOR
+#define BLOCK_ACCUMULATOR
+
+#include <complex>
+
+class BlockAccumulator{
+public:
+	/** Destructor. */
+	virtual ~BlockAccumulator(){};
+
+	/** Create an empty BlockAccumulator of the same type and with the
+	 *  same parameters.
+	 *
+	 *  @return Pointer to a new BlockAccumulator that the caller takes
+	 *  ownership of. */
+	virtual BlockAccumulator* createEmpty() const = 0;
+
+	/** Get whether the BlockAccumulator needs the eigenvectors.
+	 *
+	 *  @return True if the eigenvectors are needed. */
+	virtual bool requiresEigenVectors() const = 0;
+
+	/** Accumulate the contribution from a single block.
+	 *
+	 *  @param blockSize The number of states in the block.
+	 *  @param eigenValues The eigenvalues of the block in ascending order.
+	 *  @param eigenVectors The eigenvectors of the block on column major
+	 *  format, or nullptr if the eigenvectors have not been calculated.
+	 */
+	virtual void accumulate(
+		unsigned int blockSize,
+		const double *eigenValues,
+		const std::complex<double> *eigenVectors
+	) = 0;
+
+	/** Add the contributions accumulated by another BlockAccumulator of
+	 *  the same type.
+	 *
+	 *  @param blockAccumulator The BlockAccumulator to merge into this
+	 *  one. */
+	virtual void merge(const BlockAccumulator &blockAccumulator) = 0;
+};
+
+#endif
@@ -0,0 +1,94 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file KPMPropertyExtractor.h
+ *  @brief Extracts properties from a KPMSolver.
+ *
+ *  The properties are reconstructed from the Chebyshev moments using the
+ *  Jackson kernel to damp the Gibbs oscillations that otherwise result from
+ *  the truncation of the expansion.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef KPM_PROPERTY_EXTRACTOR
+#define KPM_PROPERTY_EXTRACTOR
+
+#include "KPMSolver.h"
+#include "TBTK/Array.h"
+#include "TBTK/Property/DOS.h"
+
+#include <vector>
+
+class KPMPropertyExtractor{
+public:
+	/** Constructor.
+	 *
+	 *  @param solver The KPMSolver to extract properties from. */
+	KPMPropertyExtractor(const KPMSolver &solver);
+
+	/** Set the energy window used for energy dependent quantities.
+	 *
+	 *  @param lowerBound The lower bound of the energy window.
+	 *  @param upperBound The upper bound of the energy window.
+	 *  @param energyResolution The number of points used to resolve the
+	 *  energy window. */
+	void setEnergyWindow(
+		double lowerBound,
+		double upperBound,
+		int energyResolution
+	);
+
+	/** Calculate the density of states.
+	 *
+	 *  @return The density of states. */
+	TBTK::Property::DOS calculateDOS() const;
+
+	/** Calculate the local density of states for a number of basis
+	 *  indices.
+	 *
+	 *  @param basisIndices The basis indices to calculate the LDOS for.
+	 *
+	 *  @return Array with ranges {basisIndices.size(), energyResolution}
+	 *  containing the LDOS. */
+	TBTK::Array<double> calculateLDOS(
+		const std::vector<unsigned int> &basisIndices
+	) const;
+private:
+	/** The KPMSolver to extract properties from. */
+	const KPMSolver &solver;
+
+	/** The energy window. */
+	double lowerBound;
+	double upperBound;
+	int energyResolution;
+
+	/** Reconstruct the energy resolved function from its Chebyshev
+	 *  moments. */
+	std::vector<double> reconstruct(const std::vector<double> &moments) const;
+};
+
+inline void KPMPropertyExtractor::setEnergyWindow(
+	double lowerBound,
+	double upperBound,
+	int energyResolution
+){
+	this->lowerBound = lowerBound;
+	this->upperBound = upperBound;
+	this->energyResolution = energyResolution;
+}
+
+#endif
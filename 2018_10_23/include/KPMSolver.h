@@ -0,0 +1,140 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file KPMSolver.h
+ *  @brief Calculates Chebyshev moments using the kernel polynomial method.
+ *
+ *  The KPMSolver only accesses the Hamiltonian through repeated
+ *  multiplications with vectors. The moments of the DOS are calculated using
+ *  stochastic trace estimation with random phase vectors, which makes the cost
+ *  O(N*M) and the memory O(N) for N sites and M moments.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef KPM_SOLVER
+#define KPM_SOLVER
+
+#include "LinearOperator.h"
+
+#include <complex>
+#include <vector>
+
+class KPMSolver{
+public:
+	/** Constructor. */
+	KPMSolver();
+
+	/** Set the Hamiltonian.
+	 *
+	 *  @param hamiltonian The Hamiltonian. Not owned by the KPMSolver. */
+	void setHamiltonian(const LinearOperator &hamiltonian);
+
+	/** Set the number of Chebyshev moments to calculate.
+	 *
+	 *  @param numMoments The number of moments. */
+	void setNumMoments(unsigned int numMoments);
+
+	/** Get the number of Chebyshev moments.
+	 *
+	 *  @return The number of moments. */
+	unsigned int getNumMoments() const;
+
+	/** Set the number of random vectors used to estimate the trace.
+	 *
+	 *  @param numRandomVectors The number of random vectors. */
+	void setNumRandomVectors(unsigned int numRandomVectors);
+
+	/** Set the seed for the random vectors. The random vectors are
+	 *  independent of the number of threads.
+	 *
+	 *  @param seed The seed. */
+	void setSeed(unsigned long seed);
+
+	/** Get the energy that is mapped to the center of the Chebyshev
+	 *  interval [-1, 1].
+	 *
+	 *  @return The center of the spectrum. */
+	double getCenter() const;
+
+	/** Get the half width of the energy interval that is mapped to the
+	 *  Chebyshev interval [-1, 1].
+	 *
+	 *  @return The half width of the spectrum. */
+	double getHalfWidth() const;
+
+	/** Calculate the moments \f$\mu_n = Tr[T_n(\tilde{H})]\f$ using
+	 *  stochastic trace estimation.
+	 *
+	 *  @return The moments. */
+	std::vector<double> calculateDOSMoments() const;
+
+	/** Calculate the moments \f$\mu_n = \langle i|T_n(\tilde{H})|i\rangle\f$
+	 *  for a given basis index.
+	 *
+	 *  @param basisIndex The basis index i.
+	 *
+	 *  @return The moments. */
+	std::vector<double> calculateLDOSMoments(unsigned int basisIndex) const;
+private:
+	/** The Hamiltonian. */
+	const LinearOperator *hamiltonian;
+
+	/** The number of moments. */
+	unsigned int numMoments;
+
+	/** The number of random vectors. */
+	unsigned int numRandomVectors;
+
+	/** The seed for the random vectors. */
+	unsigned long seed;
+
+	/** The center and half width of the spectrum. */
+	double center;
+	double halfWidth;
+
+	/** Calculate the moments \f$\langle v|T_n(\tilde{H})|v\rangle\f$. The
+	 *  vector v is overwritten. */
+	std::vector<double> calculateMoments(
+		std::vector<std::complex<double>> &v
+	) const;
+};
+
+inline void KPMSolver::setNumMoments(unsigned int numMoments){
+	this->numMoments = numMoments;
+}
+
+inline unsigned int KPMSolver::getNumMoments() const{
+	return numMoments;
+}
+
+inline void KPMSolver::setNumRandomVectors(unsigned int numRandomVectors){
+	this->numRandomVectors = numRandomVectors;
+}
+
+inline void KPMSolver::setSeed(unsigned long seed){
+	this->seed = seed;
+}
+
+inline double KPMSolver::getCenter() const{
+	return center;
+}
+
+inline double KPMSolver::getHalfWidth() const{
+	return halfWidth;
+}
+
+#endif
@@ -0,0 +1,97 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file ResultCache.h
+ *  @brief On-disk cache for the results of a BlockSolver.
+ *
+ *  The ResultCache stores the results of previous calculations in
+ *  subdirectories of a cache directory. Each subdirectory contains a
+ *  BlockStore and is named after a hash of the HoppingAmplitudeSet and the
+ *  solver configuration, which means that a calculation with an unchanged
+ *  Hamiltonian is read back from the cache instead of being solved again.
+ *
+ *  The least recently used entries are removed when the total size of the
+ *  cache exceeds a given limit. Only subdirectories that are named after a
+ *  key and contain a BlockStore checkpoint are treated as entries, and only
+ *  the files written by the BlockStore are removed from them, so other files
+ *  in the cache directory are left untouched. Different processes should use
+ *  different cache directories.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef RESULT_CACHE
+#define RESULT_CACHE
+
+#include "TBTK/HoppingAmplitudeSet.h"
+
+#include <string>
+
+class ResultCache{
+public:
+	/** Constructor.
+	 *
+	 *  @param directory The cache directory. Created if it does not
+	 *  exist.
+	 *  @param maxSize The maximum size of the cache in bytes. */
+	ResultCache(
+		const std::string &directory,
+		unsigned long maxSize = 10000000000
+	);
+
+	/** Calculate the key for a calculation.
+	 *
+	 *  @param hoppingAmplitudeSet The HoppingAmplitudeSet of the Model.
+	 *  @param configuration A string that uniquely identifies the solver
+	 *  configuration.
+	 *
+	 *  @return The key. */
+	static unsigned long calculateKey(
+		const TBTK::HoppingAmplitudeSet &hoppingAmplitudeSet,
+		const std::string &configuration
+	);
+
+	/** Get the directory for the entry with the given key. The entry is
+	 *  created if it does not exist and is marked as the most recently
+	 *  used.
+	 *
+	 *  @param key The key.
+	 *
+	 *  @return The directory of the entry. */
+	std::string getEntry(unsigned long key) const;
+
+	/** Mark the entry with the given key as the most recently used and
+	 *  evict the least recently used entries if the cache is larger than
+	 *  the maximum size. Call this once the results have been written to
+	 *  the entry, so that its size is accounted for.
+	 *
+	 *  @param key The key. */
+	void finalizeEntry(unsigned long key) const;
+private:
+	/** The cache directory. */
+	std::string directory;
+
+	/** The maximum size of the cache in bytes. */
+	unsigned long maxSize;
+
+	/** Get the name of the entry with the given key. */
+	static std::string getEntryName(unsigned long key);
+
+	/** Remove the least recently used entries until the size of the cache
+	 *  is below the maximum size. The given entry is never removed. */
+	void evict(const std::string &currentEntry) const;
+};
+
+#endif
@@ -0,0 +1,72 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file SparseHamiltonian.h
+ *  @brief Hamiltonian of a Model on compressed sparse row format.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef SPARSE_HAMILTONIAN
+#define SPARSE_HAMILTONIAN
+
+#include "LinearOperator.h"
+#include "TBTK/Model.h"
+
+#include <complex>
+#include <vector>
+
+class SparseHamiltonian : public LinearOperator{
+public:
+	/** Constructor.
+	 *
+	 *  @param model The Model to extract the Hamiltonian from. */
+	SparseHamiltonian(const TBTK::Model &model);
+
+	/** Implements LinearOperator::getBasisSize(). */
+	virtual unsigned int getBasisSize() const;
+
+	/** Implements LinearOperator::getSpectralBounds() using the
+	 *  Gershgorin circle theorem. */
+	virtual void getSpectralBounds(
+		double &lowerBound,
+		double &upperBound
+	) const;
+
+	/** Implements LinearOperator::apply(). */
+	virtual void apply(
+		const std::complex<double> *in,
+		std::complex<double> *out,
+		double scale,
+		double shift
+	) const;
+private:
+	/** Offsets into columns and values for each row, followed by the
+	 *  number of non-zero elements. */
+	std::vector<unsigned int> rowOffsets;
+
+	/** Column indices of the non-zero elements. */
+	std::vector<unsigned int> columns;
+
+	/** Values of the non-zero elements. */
+	std::vector<std::complex<double>> values;
+};
+
+inline unsigned int SparseHamiltonian::getBasisSize() const{
+	return rowOffsets.size() - 1;
+}
+
+#endif
@@ -0,0 +1,471 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file StencilHamiltonian.h
+ *  @brief Translation invariant lattice Hamiltonian defined by a stencil.
+ *
+ *  The StencilHamiltonian describes a lattice with the same hoppings on
+ *  every site without storing any matrix elements. The hoppings are given
+ *  as a stencil of displacements and applied on the fly, which makes the
+ *  memory required independent of the number of hoppings and lets the
+ *  compiler unroll the loops over the dimensions and orbitals. Sites can be
+ *  removed using an AbstractIndexFilter, and an on-site potential can be
+ *  added using a HoppingAmplitude::AmplitudeCallback. Both are evaluated
+ *  once when they are set.
+ *
+ *  The basis is ordered the same way as for a Model with Indices
+ *  {x, y, ..., orbital}, where the orbital subindex is left out if
+ *  NumOrbitals is one.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef STENCIL_HAMILTONIAN
+#define STENCIL_HAMILTONIAN
+
+#include "LinearOperator.h"
+#include "TBTK/AbstractIndexFilter.h"
+#include "TBTK/HoppingAmplitude.h"
+#include "TBTK/Index.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <array>
+#include <complex>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+/** Enum class for specifying the boundary conditions. */
+enum class BoundaryCondition{Periodic, Open};
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals = 1,
+	BoundaryCondition Boundary = BoundaryCondition::Periodic
+>
+class StencilHamiltonian : public LinearOperator{
+public:
+	/** Constructor.
+	 *
+	 *  @param size The number of sites along each direction. */
+	StencilHamiltonian(const std::array<unsigned int, Dimension> &size);
+
+	/** Add a hopping from every site r to r + displacement, together with
+	 *  its Hermitian conjugate. This corresponds to adding
+	 *  HoppingAmplitude(amplitude, {r + displacement, toOrbital},
+	 *  {r, fromOrbital}) + HC to a Model for every site r. Use setPotential()
+	 *  for on-site terms.
+	 *
+	 *  @param amplitude The hopping amplitude.
+	 *  @param displacement The displacement from the from-site to the
+	 *  to-site.
+	 *  @param toOrbital The orbital on the to-site.
+	 *  @param fromOrbital The orbital on the from-site. */
+	void addHopping(
+		std::complex<double> amplitude,
+		const std::array<int, Dimension> &displacement,
+		unsigned int toOrbital = 0,
+		unsigned int fromOrbital = 0
+	);
+
+	/** Set an on-site potential. The callback is called once for every
+	 *  state, with the to- and from-Indices both equal to the Index of the
+	 *  state, and has to be set again if the potential changes. The calls
+	 *  are made in order from a single thread, so the callback does not
+	 *  need to be thread safe.
+	 *
+	 *  @param potential Callback that returns the on-site potential. */
+	void setPotential(
+		const TBTK::HoppingAmplitude::AmplitudeCallback &potential
+	);
+
+	/** Set an IndexFilter that determines which sites are included. The
+	 *  filter is called once for every site with the Index {x, y, ...}.
+	 *
+	 *  @param filter The IndexFilter. */
+	void setFilter(const TBTK::AbstractIndexFilter &filter);
+
+	/** Implements LinearOperator::getBasisSize(). */
+	virtual unsigned int getBasisSize() const;
+
+	/** Implements LinearOperator::getSpectralBounds() using the
+	 *  Gershgorin circle theorem. */
+	virtual void getSpectralBounds(
+		double &lowerBound,
+		double &upperBound
+	) const;
+
+	/** Implements LinearOperator::apply(). */
+	virtual void apply(
+		const std::complex<double> *in,
+		std::complex<double> *out,
+		double scale,
+		double shift
+	) const;
+private:
+	/** Term in the stencil. Gives the contribution
+	 *  amplitude*in[r - displacement, fromOrbital] to
+	 *  out[r, toOrbital]. */
+	class Term{
+	public:
+		std::complex<double> amplitude;
+		std::array<int, Dimension> displacement;
+		unsigned int toOrbital;
+		unsigned int fromOrbital;
+	};
+
+	/** The number of sites along each direction. */
+	std::array<unsigned int, Dimension> size;
+
+	/** The total number of sites in the lattice. */
+	unsigned int numSites;
+
+	/** The stencil. */
+	std::vector<Term> terms;
+
+	/** On-site potential for every state in the lattice, including
+	 *  excluded sites. Empty if no potential is set. */
+	std::vector<double> potential;
+
+	/** Site number in the basis for every site in the lattice, or
+	 *  EXCLUDED. Empty if no filter is set. */
+	std::vector<unsigned int> siteToBasisSite;
+
+	/** Lattice site for every site in the basis. Empty if no filter is
+	 *  set. */
+	std::vector<unsigned int> basisSiteToSite;
+
+	/** Marks excluded sites in siteToBasisSite. */
+	static constexpr unsigned int EXCLUDED
+		= std::numeric_limits<unsigned int>::max();
+
+	/** Get the number of sites in the basis. */
+	unsigned int getNumBasisSites() const;
+
+	/** Get the lattice site for a given site in the basis. */
+	unsigned int getSite(unsigned int basisSite) const;
+
+	/** Get the coordinates for a given lattice site. */
+	std::array<int, Dimension> getCoordinates(unsigned int site) const;
+
+	/** Get the Index {x, y, ...} for the given coordinates. */
+	TBTK::Index getIndex(
+		const std::array<int, Dimension> &coordinates
+	) const;
+};
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+constexpr unsigned int StencilHamiltonian<
+	Dimension,
+	NumOrbitals,
+	Boundary
+>::EXCLUDED;
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+StencilHamiltonian<Dimension, NumOrbitals, Boundary>::StencilHamiltonian(
+	const std::array<unsigned int, Dimension> &size
+) :
+	size(size)
+{
+	numSites = 1;
+	for(unsigned int n = 0; n < Dimension; n++)
+		numSites *= size[n];
+}
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+void StencilHamiltonian<Dimension, NumOrbitals, Boundary>::addHopping(
+	std::complex<double> amplitude,
+	const std::array<int, Dimension> &displacement,
+	unsigned int toOrbital,
+	unsigned int fromOrbital
+){
+	bool isOnSite = (toOrbital == fromOrbital);
+	for(unsigned int n = 0; n < Dimension; n++){
+		TBTKAssert(
+			(unsigned int)std::abs(displacement[n]) < size[n],
+			"StencilHamiltonian::addHopping()",
+			"The displacement '" << displacement[n] << "' is too"
+			<< " large for a lattice with size '" << size[n]
+			<< "'.",
+			""
+		);
+		if(displacement[n] != 0)
+			isOnSite = false;
+	}
+	TBTKAssert(
+		toOrbital < NumOrbitals && fromOrbital < NumOrbitals,
+		"StencilHamiltonian::addHopping()",
+		"Invalid orbital.",
+		"The orbitals must be smaller than NumOrbitals."
+	);
+	TBTKAssert(
+		!isOnSite,
+		"StencilHamiltonian::addHopping()",
+		"On-site terms can not be added as hoppings.",
+		"Use StencilHamiltonian::setPotential() instead."
+	);
+
+	std::array<int, Dimension> reverseDisplacement;
+	for(unsigned int n = 0; n < Dimension; n++)
+		reverseDisplacement[n] = -displacement[n];
+
+	terms.push_back({amplitude, displacement, toOrbital, fromOrbital});
+	terms.push_back(
+		{conj(amplitude), reverseDisplacement, fromOrbital, toOrbital}
+	);
+}
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+void StencilHamiltonian<Dimension, NumOrbitals, Boundary>::setPotential(
+	const TBTK::HoppingAmplitude::AmplitudeCallback &potential
+){
+	this->potential.resize((size_t)numSites*NumOrbitals);
+	for(unsigned int site = 0; site < numSites; site++){
+		TBTK::Index index = getIndex(getCoordinates(site));
+		for(unsigned int orbital = 0; orbital < NumOrbitals; orbital++){
+			TBTK::Index stateIndex = index;
+			if(NumOrbitals > 1)
+				stateIndex.pushBack(orbital);
+
+			this->potential[(size_t)site*NumOrbitals + orbital]
+				= real(
+					potential.getHoppingAmplitude(
+						stateIndex,
+						stateIndex
+					)
+				);
+		}
+	}
+}
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+void StencilHamiltonian<Dimension, NumOrbitals, Boundary>::setFilter(
+	const TBTK::AbstractIndexFilter &filter
+){
+	siteToBasisSite.assign(numSites, EXCLUDED);
+	basisSiteToSite.clear();
+	for(unsigned int site = 0; site < numSites; site++){
+		if(filter.isIncluded(getIndex(getCoordinates(site)))){
+			siteToBasisSite[site] = basisSiteToSite.size();
+			basisSiteToSite.push_back(site);
+		}
+	}
+}
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+inline unsigned int StencilHamiltonian<
+	Dimension,
+	NumOrbitals,
+	Boundary
+>::getBasisSize() const{
+	return getNumBasisSites()*NumOrbitals;
+}
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+void StencilHamiltonian<Dimension, NumOrbitals, Boundary>::getSpectralBounds(
+	double &lowerBound,
+	double &upperBound
+) const{
+	//The sum of the absolute values of the hoppings into each orbital.
+	std::array<double, NumOrbitals> radii;
+	radii.fill(0);
+	for(unsigned int n = 0; n < terms.size(); n++)
+		radii[terms[n].toOrbital] += abs(terms[n].amplitude);
+
+	lowerBound = 0;
+	upperBound = 0;
+	for(unsigned int basisSite = 0; basisSite < getNumBasisSites(); basisSite++){
+		unsigned int site = getSite(basisSite);
+		for(unsigned int orbital = 0; orbital < NumOrbitals; orbital++){
+			double diagonal = 0;
+			if(!potential.empty())
+				diagonal = potential[(size_t)site*NumOrbitals + orbital];
+
+			if(basisSite == 0 || diagonal - radii[orbital] < lowerBound)
+				lowerBound = diagonal - radii[orbital];
+			if(basisSite == 0 || diagonal + radii[orbital] > upperBound)
+				upperBound = diagonal + radii[orbital];
+		}
+	}
+}
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+void StencilHamiltonian<Dimension, NumOrbitals, Boundary>::apply(
+	const std::complex<double> *in,
+	std::complex<double> *out,
+	double scale,
+	double shift
+) const{
+	#pragma omp parallel for
+	for(unsigned int basisSite = 0; basisSite < getNumBasisSites(); basisSite++){
+		unsigned int site = getSite(basisSite);
+		std::array<int, Dimension> coordinates = getCoordinates(site);
+
+		//Diagonal terms.
+		std::array<std::complex<double>, NumOrbitals> result;
+		for(unsigned int orbital = 0; orbital < NumOrbitals; orbital++){
+			size_t state = (size_t)basisSite*NumOrbitals + orbital;
+			double diagonal = -shift;
+			if(!potential.empty())
+				diagonal += potential[(size_t)site*NumOrbitals + orbital];
+			result[orbital] = diagonal*in[state];
+		}
+
+		//Hopping terms.
+		for(unsigned int n = 0; n < terms.size(); n++){
+			const Term &term = terms[n];
+
+			//Find the site that is hopped from. The displacements
+			//are smaller than the lattice size, which means that a
+			//single wrap is enough for periodic boundary
+			//conditions.
+			unsigned int fromSite = 0;
+			bool isInside = true;
+			for(unsigned int c = 0; c < Dimension; c++){
+				int x = coordinates[c] - term.displacement[c];
+				if(Boundary == BoundaryCondition::Periodic){
+					if(x < 0)
+						x += size[c];
+					else if(x >= (int)size[c])
+						x -= size[c];
+				}
+				else if(x < 0 || x >= (int)size[c]){
+					isInside = false;
+					break;
+				}
+				fromSite = fromSite*size[c] + x;
+			}
+			if(!isInside)
+				continue;
+
+			unsigned int fromBasisSite = fromSite;
+			if(!siteToBasisSite.empty()){
+				fromBasisSite = siteToBasisSite[fromSite];
+				if(fromBasisSite == EXCLUDED)
+					continue;
+			}
+
+			result[term.toOrbital] += term.amplitude*in[
+				(size_t)fromBasisSite*NumOrbitals + term.fromOrbital
+			];
+		}
+
+		for(unsigned int orbital = 0; orbital < NumOrbitals; orbital++){
+			out[(size_t)basisSite*NumOrbitals + orbital]
+				= scale*result[orbital];
+		}
+	}
+}
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+inline unsigned int StencilHamiltonian<
+	Dimension,
+	NumOrbitals,
+	Boundary
+>::getNumBasisSites() const{
+	if(siteToBasisSite.empty())
+		return numSites;
+	else
+		return basisSiteToSite.size();
+}
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+inline unsigned int StencilHamiltonian<
+	Dimension,
+	NumOrbitals,
+	Boundary
+>::getSite(unsigned int basisSite) const{
+	if(siteToBasisSite.empty())
+		return basisSite;
+	else
+		return basisSiteToSite[basisSite];
+}
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+inline std::array<int, Dimension> StencilHamiltonian<
+	Dimension,
+	NumOrbitals,
+	Boundary
+>::getCoordinates(unsigned int site) const{
+	std::array<int, Dimension> coordinates;
+	for(int n = Dimension - 1; n >= 0; n--){
+		coordinates[n] = site%size[n];
+		site /= size[n];
+	}
+
+	return coordinates;
+}
+
+template<
+	unsigned int Dimension,
+	unsigned int NumOrbitals,
+	BoundaryCondition Boundary
+>
+inline TBTK::Index StencilHamiltonian<
+	Dimension,
+	NumOrbitals,
+	Boundary
+>::getIndex(const std::array<int, Dimension> &coordinates) const{
+	return TBTK::Index(
+		std::vector<int>(coordinates.begin(), coordinates.end())
+	);
+}
+
+#endif
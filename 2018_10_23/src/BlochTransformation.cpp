@@ -0,0 +1,255 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file BlochTransformation.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "BlochTransformation.h"
+#include "TBTK/HoppingAmplitudeSet.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <cmath>
+#include <map>
+
+using namespace std;
+using namespace TBTK;
+
+//Tolerance used when comparing amplitudes that are related by translation.
+static const double TOLERANCE = 1e-10;
+
+BlochTransformation::BlochTransformation(
+	const Model &model,
+	const vector<int> &latticeSize
+){
+	dimension = latticeSize.size();
+	unsigned int numCells = 1;
+	for(unsigned int n = 0; n < dimension; n++)
+		numCells *= latticeSize[n];
+
+	//Group the HoppingAmplitudes by displacement and orbitals. The key
+	//is {displacement..., toOrbital.size(), toOrbital...,
+	//fromOrbital...}.
+	map<vector<int>, Hopping> uniqueHoppings;
+	map<vector<int>, unsigned int> counts;
+	const HoppingAmplitudeSet &hoppingAmplitudeSet
+		= model.getHoppingAmplitudeSet();
+	for(
+		HoppingAmplitudeSet::ConstIterator iterator
+			= hoppingAmplitudeSet.cbegin();
+		iterator != hoppingAmplitudeSet.cend();
+		++iterator
+	){
+		const Index &toIndex = (*iterator).getToIndex();
+		const Index &fromIndex = (*iterator).getFromIndex();
+		TBTKAssert(
+			toIndex.getSize() >= dimension
+			&& fromIndex.getSize() >= dimension,
+			"BlochTransformation::BlochTransformation()",
+			"Encountered the HoppingAmplitude "
+			<< toIndex.toString() << " <- "
+			<< fromIndex.toString() << ", which has fewer"
+			<< " subindices than the lattice dimension.",
+			"The Indices should be on the form {x_1, ..., x_D,"
+			<< " orbital...}."
+		);
+
+		Hopping hopping;
+		for(unsigned int n = 0; n < dimension; n++){
+			TBTKAssert(
+				toIndex[n] >= 0 && toIndex[n] < latticeSize[n]
+				&& fromIndex[n] >= 0
+				&& fromIndex[n] < latticeSize[n],
+				"BlochTransformation::BlochTransformation()",
+				"Encountered the HoppingAmplitude "
+				<< toIndex.toString() << " <- "
+				<< fromIndex.toString() << ", which lies"
+				<< " outside of the lattice.",
+				""
+			);
+
+			//Use the shortest displacement compatible with the
+			//periodic boundary conditions.
+			int d = toIndex[n] - fromIndex[n];
+			d = ((d%latticeSize[n]) + latticeSize[n])%latticeSize[n];
+			if(2*d >= latticeSize[n])
+				d -= latticeSize[n];
+			hopping.displacement.push_back(d);
+		}
+		for(unsigned int n = dimension; n < toIndex.getSize(); n++)
+			hopping.toOrbital.push_back(toIndex[n]);
+		for(unsigned int n = dimension; n < fromIndex.getSize(); n++)
+			hopping.fromOrbital.push_back(fromIndex[n]);
+		hopping.amplitude = (*iterator).getAmplitude();
+
+		vector<int> key = hopping.displacement;
+		key.push_back(hopping.toOrbital.size());
+		key.insert(
+			key.end(),
+			hopping.toOrbital.begin(),
+			hopping.toOrbital.end()
+		);
+		key.insert(
+			key.end(),
+			hopping.fromOrbital.begin(),
+			hopping.fromOrbital.end()
+		);
+
+		//Verify that the amplitude is the same as for all previously
+		//encountered translations of the same hopping.
+		map<vector<int>, Hopping>::iterator uniqueHopping
+			= uniqueHoppings.find(key);
+		if(uniqueHopping == uniqueHoppings.end()){
+			uniqueHoppings[key] = hopping;
+			counts[key] = 1;
+		}
+		else{
+			TBTKAssert(
+				abs(
+					uniqueHopping->second.amplitude
+					- hopping.amplitude
+				) < TOLERANCE,
+				"BlochTransformation::BlochTransformation()",
+				"The Model is not translation invariant. The"
+				<< " HoppingAmplitude " << toIndex.toString()
+				<< " <- " << fromIndex.toString() << " has"
+				<< " the amplitude " << hopping.amplitude
+				<< ", while a translation of it has the"
+				<< " amplitude "
+				<< uniqueHopping->second.amplitude << ".",
+				""
+			);
+			counts[key]++;
+		}
+	}
+
+	//Verify that every hopping is present in every unit cell and group
+	//the hoppings by orbital pairs.
+	map<vector<int>, unsigned int> orbitalPairs;
+	for(
+		map<vector<int>, Hopping>::const_iterator iterator
+			= uniqueHoppings.begin();
+		iterator != uniqueHoppings.end();
+		++iterator
+	){
+		TBTKAssert(
+			counts[iterator->first] == numCells,
+			"BlochTransformation::BlochTransformation()",
+			"The Model is not translation invariant. A hopping"
+			<< " is present in " << counts[iterator->first]
+			<< " out of " << numCells << " unit cells.",
+			"Make sure that the real-space Model has periodic"
+			<< " boundary conditions."
+		);
+
+		const Hopping &hopping = iterator->second;
+		vector<int> orbitalPair = {(int)hopping.toOrbital.size()};
+		orbitalPair.insert(
+			orbitalPair.end(),
+			hopping.toOrbital.begin(),
+			hopping.toOrbital.end()
+		);
+		orbitalPair.insert(
+			orbitalPair.end(),
+			hopping.fromOrbital.begin(),
+			hopping.fromOrbital.end()
+		);
+		map<vector<int>, unsigned int>::iterator group
+			= orbitalPairs.find(orbitalPair);
+		if(group == orbitalPairs.end()){
+			orbitalPairs[orbitalPair] = hoppings.size();
+			hoppings.push_back(vector<Hopping>());
+			hoppings.back().push_back(hopping);
+		}
+		else{
+			hoppings[group->second].push_back(hopping);
+		}
+	}
+}
+
+Model BlochTransformation::createModel(
+	const vector<int> &kMeshSize,
+	int kxBegin,
+	int kxEnd
+) const{
+	TBTKAssert(
+		kMeshSize.size() == dimension,
+		"BlochTransformation::createModel()",
+		"The k-mesh has dimension " << kMeshSize.size() << ", but the"
+		<< " lattice has dimension " << dimension << ".",
+		""
+	);
+
+	unsigned int numKPoints = kxEnd - kxBegin;
+	for(unsigned int n = 1; n < dimension; n++)
+		numKPoints *= kMeshSize[n];
+
+	Model model;
+	vector<int> kIndex(dimension);
+	for(unsigned int k = 0; k < numKPoints; k++){
+		//Calculate the k-index with the last direction running
+		//fastest.
+		unsigned int remainder = k;
+		for(int n = dimension - 1; n > 0; n--){
+			kIndex[n] = remainder%kMeshSize[n];
+			remainder /= kMeshSize[n];
+		}
+		kIndex[0] = kxBegin + remainder;
+
+		//Add one HoppingAmplitude per orbital pair, given by
+		//H_k = sum_d a_d*exp(-ik.d). The HoppingAmplitude is added
+		//even if the sum vanishes at this k-point, so that every block
+		//contains the same orbitals as the unit cell of the real-space
+		//Model.
+		for(unsigned int g = 0; g < hoppings.size(); g++){
+			complex<double> amplitude = 0;
+			for(unsigned int h = 0; h < hoppings[g].size(); h++){
+				const Hopping &hopping = hoppings[g][h];
+				double phase = 0;
+				for(unsigned int n = 0; n < dimension; n++){
+					phase += 2*M_PI*kIndex[n]
+						*hopping.displacement[n]
+						/(double)kMeshSize[n];
+				}
+				amplitude += hopping.amplitude*exp(
+					complex<double>(0, -phase)
+				);
+			}
+
+			vector<int> toIndex = kIndex;
+			toIndex.insert(
+				toIndex.end(),
+				hoppings[g][0].toOrbital.begin(),
+				hoppings[g][0].toOrbital.end()
+			);
+			vector<int> fromIndex = kIndex;
+			fromIndex.insert(
+				fromIndex.end(),
+				hoppings[g][0].fromOrbital.begin(),
+				hoppings[g][0].fromOrbital.end()
+			);
+			model << HoppingAmplitude(
+				amplitude,
+				Index(toIndex),
+				Index(fromIndex)
+			);
+		}
+	}
+	model.construct();
+
+	return model;
+}
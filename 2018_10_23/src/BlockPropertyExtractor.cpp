@@ -0,0 +1,75 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file BlockPropertyExtractor.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "BlockPropertyExtractor.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace TBTK;
+
+BlockPropertyExtractor::BlockPropertyExtractor(
+	const BlockSolver &solver
+) :
+	solver(solver)
+{
+	lowerBound = -1;
+	upperBound = 1;
+	energyResolution = 1000;
+}
+
+Property::DOS BlockPropertyExtractor::calculateDOS() const{
+	TBTKAssert(
+		solver.getStoreResults(),
+		"BlockPropertyExtractor::calculateDOS()",
+		"The BlockSolver has not stored the eigenvalues.",
+		"Add a DOSAccumulator to the BlockSolver to calculate the DOS"
+		<< " without storing the eigenvalues."
+	);
+
+	Property::DOS dos(lowerBound, upperBound, energyResolution);
+	double dE = (upperBound - lowerBound)/energyResolution;
+	for(unsigned int n = 0; n < solver.getBasisSize(); n++){
+		int e = (int)floor((solver.getEigenValue(n) - lowerBound)/dE);
+		if(e >= 0 && e < energyResolution)
+			dos(e) += 1./dE;
+	}
+
+	return dos;
+}
+
+complex<double> BlockPropertyExtractor::getAmplitude(
+	const Index &blockIndex,
+	unsigned int state,
+	const Index &index
+) const{
+	TBTKAssert(
+		solver.getMode()
+			== BlockSolver::Mode::EigenValuesAndEigenVectors,
+		"BlockPropertyExtractor::getAmplitude()",
+		"The BlockSolver has only calculated the eigenvalues.",
+		"Set the BlockSolver to"
+		<< " BlockSolver::Mode::EigenValuesAndEigenVectors to be able"
+		<< " to extract eigenvector dependent properties."
+	);
+
+	return solver.getAmplitude(blockIndex, state, index);
+}
@@ -0,0 +1,103 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file KPMPropertyExtractor.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "KPMPropertyExtractor.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace TBTK;
+
+KPMPropertyExtractor::KPMPropertyExtractor(
+	const KPMSolver &solver
+) :
+	solver(solver)
+{
+	lowerBound = -1;
+	upperBound = 1;
+	energyResolution = 1000;
+}
+
+Property::DOS KPMPropertyExtractor::calculateDOS() const{
+	vector<double> dosValues = reconstruct(solver.calculateDOSMoments());
+
+	Property::DOS dos(lowerBound, upperBound, energyResolution);
+	for(int e = 0; e < energyResolution; e++)
+		dos(e) = dosValues[e];
+
+	return dos;
+}
+
+Array<double> KPMPropertyExtractor::calculateLDOS(
+	const vector<unsigned int> &basisIndices
+) const{
+	Array<double> ldos(
+		{(unsigned int)basisIndices.size(), (unsigned int)energyResolution},
+		0
+	);
+	for(unsigned int n = 0; n < basisIndices.size(); n++){
+		vector<double> ldosValues = reconstruct(
+			solver.calculateLDOSMoments(basisIndices[n])
+		);
+		for(int e = 0; e < energyResolution; e++)
+			ldos[{n, (unsigned int)e}] = ldosValues[e];
+	}
+
+	return ldos;
+}
+
+vector<double> KPMPropertyExtractor::reconstruct(
+	const vector<double> &moments
+) const{
+	unsigned int numMoments = moments.size();
+	double center = solver.getCenter();
+	double halfWidth = solver.getHalfWidth();
+
+	//Multiply the moments by the Jackson kernel.
+	vector<double> dampedMoments(numMoments);
+	for(unsigned int n = 0; n < numMoments; n++){
+		double N = numMoments + 1;
+		dampedMoments[n] = moments[n]*(
+			(N - n)*cos(M_PI*n/N) + sin(M_PI*n/N)/tan(M_PI/N)
+		)/N;
+	}
+
+	//Evaluate rho(E) = [mu_0 + 2 sum_n mu_n T_n(x)]/(pi*sqrt(1 - x^2))
+	//with x = (E - center)/halfWidth. The Chebyshev polynomials are
+	//evaluated as T_n(x) = cos(n*acos(x)), and the result is divided by
+	//the half width to account for the change of variables.
+	vector<double> result(energyResolution, 0);
+	double dE = (upperBound - lowerBound)/(energyResolution - 1);
+	#pragma omp parallel for
+	for(int e = 0; e < energyResolution; e++){
+		double x = (lowerBound + e*dE - center)/halfWidth;
+		if(x <= -1 || x >= 1)
+			continue;
+
+		double theta = acos(x);
+		double value = dampedMoments[0];
+		for(unsigned int n = 1; n < numMoments; n++)
+			value += 2*dampedMoments[n]*cos(n*theta);
+		result[e] = value/(M_PI*sqrt(1 - x*x)*halfWidth);
+	}
+
+	return result;
+}
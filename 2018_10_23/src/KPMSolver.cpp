@@ -0,0 +1,162 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file KPMSolver.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "KPMSolver.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace std;
+
+//Margin that keeps the scaled spectrum strictly inside [-1, 1].
+static const double SPECTRAL_MARGIN = 0.01;
+
+//Number of elements per partial sum in the dot products. The partial sums
+//are added in a fixed order, which makes the result independent of the
+//number of threads.
+static const unsigned int DOT_CHUNK_SIZE = 1 << 14;
+
+KPMSolver::KPMSolver(){
+	hamiltonian = nullptr;
+	numMoments = 1000;
+	numRandomVectors = 10;
+	seed = 0;
+	center = 0;
+	halfWidth = 1;
+}
+
+void KPMSolver::setHamiltonian(const LinearOperator &hamiltonian){
+	this->hamiltonian = &hamiltonian;
+
+	double lowerBound, upperBound;
+	hamiltonian.getSpectralBounds(lowerBound, upperBound);
+	center = (upperBound + lowerBound)/2.;
+	halfWidth = (upperBound - lowerBound)/(2. - SPECTRAL_MARGIN);
+	if(halfWidth == 0)
+		halfWidth = 1;
+}
+
+vector<double> KPMSolver::calculateDOSMoments() const{
+	TBTKAssert(
+		hamiltonian != nullptr,
+		"KPMSolver::calculateDOSMoments()",
+		"Hamiltonian not set.",
+		"Use KPMSolver::setHamiltonian() to set the Hamiltonian."
+	);
+	unsigned int basisSize = hamiltonian->getBasisSize();
+
+	//Calculate the moments for one random vector at a time and average
+	//them. The random vectors are processed one by one so that only three
+	//vectors of size N are kept in memory. The parallelism instead comes
+	//from the matrix-vector multiplications and the vector operations.
+	vector<double> moments(numMoments, 0);
+	vector<complex<double>> v(basisSize);
+	for(unsigned int r = 0; r < numRandomVectors; r++){
+		mt19937_64 generator(seed + r);
+		uniform_real_distribution<double> distribution(0, 2*M_PI);
+		for(unsigned int n = 0; n < basisSize; n++)
+			v[n] = polar(1., distribution(generator));
+
+		vector<double> randomVectorMoments = calculateMoments(v);
+		for(unsigned int n = 0; n < numMoments; n++)
+			moments[n] += randomVectorMoments[n]/numRandomVectors;
+	}
+
+	return moments;
+}
+
+vector<double> KPMSolver::calculateLDOSMoments(unsigned int basisIndex) const{
+	TBTKAssert(
+		hamiltonian != nullptr,
+		"KPMSolver::calculateLDOSMoments()",
+		"Hamiltonian not set.",
+		"Use KPMSolver::setHamiltonian() to set the Hamiltonian."
+	);
+
+	vector<complex<double>> v(hamiltonian->getBasisSize(), 0.);
+	v[basisIndex] = 1;
+
+	return calculateMoments(v);
+}
+
+vector<double> KPMSolver::calculateMoments(vector<complex<double>> &v) const{
+	unsigned int basisSize = v.size();
+	vector<double> moments(numMoments, 0);
+
+	//Real part of the dot product between two vectors. The partial sums
+	//are calculated in parallel and then added in order.
+	unsigned int numChunks = (basisSize + DOT_CHUNK_SIZE - 1)/DOT_CHUNK_SIZE;
+	vector<double> partialSums(numChunks);
+	auto dot = [basisSize, numChunks, &partialSums](
+		const vector<complex<double>> &v0,
+		const vector<complex<double>> &v1
+	){
+		#pragma omp parallel for
+		for(unsigned int chunk = 0; chunk < numChunks; chunk++){
+			unsigned int first = chunk*DOT_CHUNK_SIZE;
+			unsigned int last = min(first + DOT_CHUNK_SIZE, basisSize);
+			double sum = 0;
+			for(unsigned int n = first; n < last; n++)
+				sum += real(conj(v0[n])*v1[n]);
+			partialSums[chunk] = sum;
+		}
+
+		double result = 0;
+		for(unsigned int chunk = 0; chunk < numChunks; chunk++)
+			result += partialSums[chunk];
+
+		return result;
+	};
+
+	//Calculate |phi_1> = T_1(H)|phi_0>. The recursion
+	//|phi_{n+1}> = 2H|phi_n> - |phi_{n-1}> is then combined with the
+	//relations mu_{2n} = 2<phi_n|phi_n> - mu_0 and
+	//mu_{2n+1} = 2<phi_{n+1}|phi_n> - mu_1 to obtain two moments per
+	//multiplication.
+	vector<complex<double>> &previous = v;
+	vector<complex<double>> current(basisSize);
+	vector<complex<double>> next(basisSize);
+	hamiltonian->apply(previous.data(), current.data(), 1/halfWidth, center);
+	double mu0 = dot(previous, previous);
+	double mu1 = dot(previous, current);
+	if(numMoments > 0)
+		moments[0] = mu0;
+	if(numMoments > 1)
+		moments[1] = mu1;
+
+	for(unsigned int n = 1; 2*n < numMoments; n++){
+		moments[2*n] = 2*dot(current, current) - mu0;
+		if(2*n + 1 == numMoments)
+			break;
+
+		hamiltonian->apply(current.data(), next.data(), 2/halfWidth, center);
+		#pragma omp parallel for
+		for(unsigned int c = 0; c < basisSize; c++)
+			next[c] -= previous[c];
+		moments[2*n + 1] = 2*dot(next, current) - mu1;
+
+		previous.swap(current);
+		current.swap(next);
+	}
+
+	return moments;
+}
@@ -0,0 +1,254 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file ResultCache.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "ResultCache.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <complex>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace TBTK;
+
+//Updates a 64-bit FNV-1a hash.
+static unsigned long updateHash(
+	const void *data,
+	size_t size,
+	unsigned long hash
+){
+	const unsigned char *bytes = (const unsigned char*)data;
+	for(size_t n = 0; n < size; n++){
+		hash ^= bytes[n];
+		hash *= 0x100000001b3;
+	}
+
+	return hash;
+}
+
+//Updates a hash with an Index.
+static unsigned long updateHash(const Index &index, unsigned long hash){
+	unsigned int size = index.getSize();
+	hash = updateHash(&size, sizeof(size), hash);
+	for(unsigned int n = 0; n < size; n++){
+		int subindex = index[n];
+		hash = updateHash(&subindex, sizeof(subindex), hash);
+	}
+
+	return hash;
+}
+
+//Lists the names of the entries in a directory.
+static vector<string> listDirectory(const string &directory){
+	vector<string> names;
+	DIR *dir = opendir(directory.c_str());
+	if(dir == nullptr)
+		return names;
+
+	while(dirent *entry = readdir(dir)){
+		string name = entry->d_name;
+		if(name != "." && name != "..")
+			names.push_back(name);
+	}
+	closedir(dir);
+
+	return names;
+}
+
+//Returns true if the name has the format of the entries created by
+//getEntry(), which is a key on hexadecimal format.
+static bool isEntryName(const string &name){
+	if(name.empty() || name.size() > 2*sizeof(unsigned long))
+		return false;
+	for(unsigned int n = 0; n < name.size(); n++)
+		if(!isdigit(name[n]) && (name[n] < 'a' || name[n] > 'f'))
+			return false;
+
+	return true;
+}
+
+//Returns true if the name is that of a file written by a BlockStore.
+static bool isBlockStoreFile(const string &name){
+	if(name == "checkpoint" || name == "checkpoint.tmp")
+		return true;
+	if(name.size() <= 6 || name.compare(0, 6, "chunk_") != 0)
+		return false;
+	for(unsigned int n = 6; n < name.size(); n++)
+		if(!isdigit(name[n]))
+			return false;
+
+	return true;
+}
+
+ResultCache::ResultCache(const string &directory, unsigned long maxSize){
+	this->directory = directory;
+	this->maxSize = maxSize;
+
+	//Create the directory and its parents.
+	for(size_t n = 1; n <= directory.size(); n++){
+		if(n == directory.size() || directory[n] == '/'){
+			string path = directory.substr(0, n);
+			TBTKAssert(
+				mkdir(path.c_str(), 0755) == 0
+				|| errno == EEXIST,
+				"ResultCache::ResultCache()",
+				"Unable to create the directory '" << path
+				<< "'.",
+				""
+			);
+		}
+	}
+}
+
+unsigned long ResultCache::calculateKey(
+	const HoppingAmplitudeSet &hoppingAmplitudeSet,
+	const string &configuration
+){
+	unsigned long key = updateHash(
+		configuration.data(),
+		configuration.size(),
+		0xcbf29ce484222325
+	);
+	for(
+		HoppingAmplitudeSet::ConstIterator iterator
+			= hoppingAmplitudeSet.cbegin();
+		iterator != hoppingAmplitudeSet.cend();
+		++iterator
+	){
+		complex<double> amplitude = (*iterator).getAmplitude();
+		key = updateHash((*iterator).getToIndex(), key);
+		key = updateHash((*iterator).getFromIndex(), key);
+		key = updateHash(&amplitude, sizeof(amplitude), key);
+	}
+
+	return key;
+}
+
+string ResultCache::getEntry(unsigned long key) const{
+	string entry = directory + "/" + getEntryName(key);
+
+	//Create the entry and mark it as the most recently used.
+	TBTKAssert(
+		mkdir(entry.c_str(), 0755) == 0 || errno == EEXIST,
+		"ResultCache::getEntry()",
+		"Unable to create the directory '" << entry << "'.",
+		""
+	);
+	utimes(entry.c_str(), nullptr);
+
+	return entry;
+}
+
+void ResultCache::finalizeEntry(unsigned long key) const{
+	string name = getEntryName(key);
+	utimes((directory + "/" + name).c_str(), nullptr);
+
+	evict(name);
+}
+
+string ResultCache::getEntryName(unsigned long key){
+	stringstream ss;
+	ss << hex << key;
+
+	return ss.str();
+}
+
+void ResultCache::evict(const string &currentEntry) const{
+	//Calculate the size and modification time of each entry. Only
+	//directories that are named after a key and contain a BlockStore
+	//checkpoint are considered to be entries, so that nothing else in the
+	//cache directory is ever removed.
+	class Entry{
+	public:
+		string name;
+		unsigned long size;
+		time_t modificationTime;
+	};
+	vector<Entry> entries;
+	unsigned long totalSize = 0;
+	vector<string> names = listDirectory(directory);
+	for(unsigned int n = 0; n < names.size(); n++){
+		string path = directory + "/" + names[n];
+		struct stat status;
+		if(
+			!isEntryName(names[n])
+			|| stat(path.c_str(), &status) != 0
+			|| !S_ISDIR(status.st_mode)
+		){
+			continue;
+		}
+		struct stat checkpointStatus;
+		if(
+			stat((path + "/checkpoint").c_str(), &checkpointStatus)
+				!= 0
+			|| !S_ISREG(checkpointStatus.st_mode)
+		){
+			continue;
+		}
+
+		Entry entry = {names[n], 0, status.st_mtime};
+		vector<string> files = listDirectory(path);
+		for(unsigned int c = 0; c < files.size(); c++){
+			if(!isBlockStoreFile(files[c]))
+				continue;
+			string file = path + "/" + files[c];
+			struct stat fileStatus;
+			if(stat(file.c_str(), &fileStatus) == 0)
+				entry.size += fileStatus.st_size;
+		}
+		totalSize += entry.size;
+		entries.push_back(entry);
+	}
+
+	//Remove the least recently used entries.
+	sort(
+		entries.begin(),
+		entries.end(),
+		[](const Entry &entry0, const Entry &entry1){
+			return entry0.modificationTime
+				< entry1.modificationTime;
+		}
+	);
+	for(unsigned int n = 0; n < entries.size(); n++){
+		if(totalSize <= maxSize)
+			break;
+		if(entries[n].name == currentEntry)
+			continue;
+
+		//Only the files written by the BlockStore are removed. The
+		//directory itself is only removed if it then is empty.
+		string path = directory + "/" + entries[n].name;
+		vector<string> files = listDirectory(path);
+		for(unsigned int c = 0; c < files.size(); c++)
+			if(isBlockStoreFile(files[c]))
+				remove((path + "/" + files[c]).c_str());
+		rmdir(path.c_str());
+		totalSize -= entries[n].size;
+	}
+}
@@ -0,0 +1,114 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file SparseHamiltonian.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "SparseHamiltonian.h"
+#include "TBTK/HoppingAmplitudeSet.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace TBTK;
+
+SparseHamiltonian::SparseHamiltonian(const Model &model){
+	const HoppingAmplitudeSet &hoppingAmplitudeSet
+		= model.getHoppingAmplitudeSet();
+	unsigned int basisSize = hoppingAmplitudeSet.getBasisSize();
+
+	//Convert the HoppingAmplitudes to linear indices.
+	vector<unsigned int> rows;
+	for(
+		HoppingAmplitudeSet::ConstIterator iterator
+			= hoppingAmplitudeSet.cbegin();
+		iterator != hoppingAmplitudeSet.cend();
+		++iterator
+	){
+		rows.push_back(
+			hoppingAmplitudeSet.getBasisIndex(
+				(*iterator).getToIndex()
+			)
+		);
+		columns.push_back(
+			hoppingAmplitudeSet.getBasisIndex(
+				(*iterator).getFromIndex()
+			)
+		);
+		values.push_back((*iterator).getAmplitude());
+	}
+
+	//Sort the elements by row.
+	rowOffsets.assign(basisSize + 1, 0);
+	for(unsigned int n = 0; n < rows.size(); n++)
+		rowOffsets[rows[n] + 1]++;
+	for(unsigned int row = 0; row < basisSize; row++)
+		rowOffsets[row + 1] += rowOffsets[row];
+
+	vector<unsigned int> sortedColumns(columns.size());
+	vector<complex<double>> sortedValues(values.size());
+	vector<unsigned int> position(
+		rowOffsets.begin(),
+		rowOffsets.end() - 1
+	);
+	for(unsigned int n = 0; n < rows.size(); n++){
+		sortedColumns[position[rows[n]]] = columns[n];
+		sortedValues[position[rows[n]]] = values[n];
+		position[rows[n]]++;
+	}
+	columns.swap(sortedColumns);
+	values.swap(sortedValues);
+}
+
+void SparseHamiltonian::getSpectralBounds(
+	double &lowerBound,
+	double &upperBound
+) const{
+	lowerBound = 0;
+	upperBound = 0;
+	for(unsigned int row = 0; row < getBasisSize(); row++){
+		double diagonal = 0;
+		double radius = 0;
+		for(unsigned int n = rowOffsets[row]; n < rowOffsets[row+1]; n++){
+			if(columns[n] == row)
+				diagonal += real(values[n]);
+			else
+				radius += abs(values[n]);
+		}
+
+		if(row == 0 || diagonal - radius < lowerBound)
+			lowerBound = diagonal - radius;
+		if(row == 0 || diagonal + radius > upperBound)
+			upperBound = diagonal + radius;
+	}
+}
+
+void SparseHamiltonian::apply(
+	const complex<double> *in,
+	complex<double> *out,
+	double scale,
+	double shift
+) const{
+	#pragma omp parallel for
+	for(unsigned int row = 0; row < getBasisSize(); row++){
+		complex<double> result = -shift*in[row];
+		for(unsigned int n = rowOffsets[row]; n < rowOffsets[row+1]; n++)
+			result += values[n]*in[columns[n]];
+		out[row] = scale*result;
+	}
+}
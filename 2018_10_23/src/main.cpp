@@ -13,36 +13,126 @@
  * limitations under the License.
  */
 
+#include "BlochTransformation.h"
+#include "BlockPropertyExtractor.h"
+#include "BlockSolver.h"
+#include "ResultCache.h"
 #include "TBTK/Model.h"
-#include "TBTK/PropertyExtractor/BlockDiagonalizer.h"
-#include "TBTK/Solver/BlockDiagonalizer.h"
 #include "TBTK/Smooth.h"
 #include "TBTK/Streams.h"
 #include "TBTK/TBTK.h"
 #include "TBTK/Visualization/MatPlotLib/Plotter.h"
 
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <memory>
+
+#include <omp.h>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
 using namespace std;
 using namespace TBTK;
 using namespace Visualization::MatPlotLib;
 
+//Returns the rank of the current process.
+int getRank(){
+#ifdef USE_MPI
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	return rank;
+#else
+	return 0;
+#endif
+}
+
+//Returns the number of processes.
+int getNumRanks(){
+#ifdef USE_MPI
+	int numRanks;
+	MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+	return numRanks;
+#else
+	return 1;
+#endif
+}
+
+//Calculates the range [begin, end) of the k-indices along an axis with the
+//given size that the current process is responsible for.
+void getShard(int size, int &begin, int &end){
+	begin = (size*getRank())/getNumRanks();
+	end = (size*(getRank() + 1))/getNumRanks();
+}
+
+//Sums the DOS over all processes.
+void reduce(Property::DOS &dos){
+#ifdef USE_MPI
+	vector<double> buffer(dos.getResolution());
+	for(unsigned int c = 0; c < dos.getResolution(); c++)
+		buffer[c] = dos(c);
+	MPI_Allreduce(
+		MPI_IN_PLACE,
+		buffer.data(),
+		buffer.size(),
+		MPI_DOUBLE,
+		MPI_SUM,
+		MPI_COMM_WORLD
+	);
+	for(unsigned int c = 0; c < dos.getResolution(); c++)
+		dos(c) = buffer[c];
+#endif
+}
+
+//Sums the basis size over all processes.
+int reduce(int basisSize){
+#ifdef USE_MPI
+	MPI_Allreduce(
+		MPI_IN_PLACE,
+		&basisSize,
+		1,
+		MPI_INT,
+		MPI_SUM,
+		MPI_COMM_WORLD
+	);
+#endif
+	return basisSize;
+}
+
+//Size of the real-space lattices that the k-space Models are created from.
+//Needs to be more than twice the hopping range.
+const int TEMPLATE_SIZE = 4;
+
 Model createModel1D(){
 	//Parameters.
 	const int SIZE_X = 10000;
 	double t = 1;
 
-	//Create the Model.
-	Model model;
-	for(int kx = 0; kx < SIZE_X; kx++){
-		double KX = 2*M_PI*kx/(double)SIZE_X - M_PI;
-		model << HoppingAmplitude(
-			-2*t*cos(KX),
-			{kx},
-			{kx}
-		);
+	//Create a periodic real-space Model.
+	Model realSpaceModel;
+	for(int x = 0; x < TEMPLATE_SIZE; x++){
+		realSpaceModel << HoppingAmplitude(
+			-t,
+			{(x+1)%TEMPLATE_SIZE},
+			{x}
+		) + HC;
 	}
-	model.construct();
+	realSpaceModel.construct();
+
+	//Get the k-points along the x-axis that this process is
+	//responsible for.
+	int kxBegin, kxEnd;
+	getShard(SIZE_X, kxBegin, kxEnd);
+
+	//Create the k-space Model.
+	BlochTransformation blochTransformation(
+		realSpaceModel,
+		{TEMPLATE_SIZE}
+	);
 
-	return model;
+	return blochTransformation.createModel({SIZE_X}, kxBegin, kxEnd);
 }
 
 Model createModel2D(){
@@ -51,22 +141,40 @@ Model createModel2D(){
 	const int SIZE_Y = 500;
 	double t = 1;
 
-	//Create the Model.
-	Model model;
-	for(int kx = 0; kx < SIZE_X; kx++){
-		for(int ky = 0; ky < SIZE_Y; ky++){
-			double KX = 2*M_PI*kx/(double)SIZE_X - M_PI;
-			double KY = 2*M_PI*ky/(double)SIZE_Y - M_PI;
-			model << HoppingAmplitude(
-				-2*t*(cos(KX) + cos(KY)),
-				{kx, ky},
-				{kx, ky}
-			);
+	//Create a periodic real-space Model.
+	Model realSpaceModel;
+	for(int x = 0; x < TEMPLATE_SIZE; x++){
+		for(int y = 0; y < TEMPLATE_SIZE; y++){
+			realSpaceModel << HoppingAmplitude(
+				-t,
+				{(x+1)%TEMPLATE_SIZE, y},
+				{x, y}
+			) + HC;
+			realSpaceModel << HoppingAmplitude(
+				-t,
+				{x, (y+1)%TEMPLATE_SIZE},
+				{x, y}
+			) + HC;
 		}
 	}
-	model.construct();
+	realSpaceModel.construct();
 
-	return model;
+	//Get the k-points along the x-axis that this process is
+	//responsible for.
+	int kxBegin, kxEnd;
+	getShard(SIZE_X, kxBegin, kxEnd);
+
+	//Create the k-space Model.
+	BlochTransformation blochTransformation(
+		realSpaceModel,
+		{TEMPLATE_SIZE, TEMPLATE_SIZE}
+	);
+
+	return blochTransformation.createModel(
+		{SIZE_X, SIZE_Y},
+		kxBegin,
+		kxEnd
+	);
 }
 
 Model createModel3D(){
@@ -76,31 +184,100 @@ Model createModel3D(){
 	const int SIZE_Z = 200;
 	double t = 1;
 
-	//Create the Model.
-	Model model;
-	for(int kx = 0; kx < SIZE_X; kx++){
-		for(int ky = 0; ky < SIZE_Y; ky++){
-			for(int kz = 0; kz < SIZE_Z; kz++){
-				double KX = 2*M_PI*kx/(double)SIZE_X - M_PI;
-				double KY = 2*M_PI*ky/(double)SIZE_Y - M_PI;
-				double KZ = 2*M_PI*kz/(double)SIZE_Z - M_PI;
-				model << HoppingAmplitude(
-					-2*t*(cos(KX) + cos(KY) + cos(KZ)),
-					{kx, ky, kz},
-					{kx, ky, kz}
-				);
+	//Create a periodic real-space Model.
+	Model realSpaceModel;
+	for(int x = 0; x < TEMPLATE_SIZE; x++){
+		for(int y = 0; y < TEMPLATE_SIZE; y++){
+			for(int z = 0; z < TEMPLATE_SIZE; z++){
+				realSpaceModel << HoppingAmplitude(
+					-t,
+					{(x+1)%TEMPLATE_SIZE, y, z},
+					{x, y, z}
+				) + HC;
+				realSpaceModel << HoppingAmplitude(
+					-t,
+					{x, (y+1)%TEMPLATE_SIZE, z},
+					{x, y, z}
+				) + HC;
+				realSpaceModel << HoppingAmplitude(
+					-t,
+					{x, y, (z+1)%TEMPLATE_SIZE},
+					{x, y, z}
+				) + HC;
 			}
 		}
 	}
-	model.construct();
+	realSpaceModel.construct();
+
+	//Get the k-points along the x-axis that this process is
+	//responsible for.
+	int kxBegin, kxEnd;
+	getShard(SIZE_X, kxBegin, kxEnd);
+
+	//Create the k-space Model.
+	BlochTransformation blochTransformation(
+		realSpaceModel,
+		{TEMPLATE_SIZE, TEMPLATE_SIZE, TEMPLATE_SIZE}
+	);
+
+	return blochTransformation.createModel(
+		{SIZE_X, SIZE_Y, SIZE_Z},
+		kxBegin,
+		kxEnd
+	);
+}
+
+//Returns the number of threads passed as an argument. Prints a usage message
+//and exits if it is not a positive integer.
+int parseNumThreads(const char *argument){
+	char *end;
+	errno = 0;
+	long numThreads = strtol(argument, &end, 10);
+	if(
+		end == argument || *end != '\0' || errno != 0
+		|| numThreads < 1 || numThreads > INT_MAX
+	){
+		if(getRank() == 0){
+			Streams::out << "Error: The number of threads must be a"
+				<< " positive integer, but '" << argument
+				<< "' was given.\n"
+				<< "Usage: Application [numThreads] [cacheDirectory]\n";
+		}
+#ifdef USE_MPI
+		MPI_Finalize();
+#endif
+		exit(1);
+	}
 
-	return model;
+	return numThreads;
 }
 
 int main(int argc, char **argv){
+#ifdef USE_MPI
+	//Initialize MPI.
+	MPI_Init(&argc, &argv);
+#endif
+
 	//Initialize TBTK.
 	Initialize();
 
+	//Set the number of threads to solve the blocks with. All available
+	//cores are used unless the number of threads is passed as the first
+	//argument.
+	if(argc > 1)
+		omp_set_num_threads(parseNumThreads(argv[1]));
+
+	//Cache the results in the directory passed as the second argument.
+	//Models that have been solved before are then read back from the
+	//cache instead of being solved again.
+	unique_ptr<ResultCache> cache;
+	if(argc > 2){
+		string directory = argv[2];
+		if(getNumRanks() > 1)
+			directory += "/" + to_string(getRank());
+		cache.reset(new ResultCache(directory));
+	}
+
 	//Filenames to save the figures as.
 	string filenames[3] = {
 		"figures/DOS_1D.png",
@@ -127,19 +304,29 @@ int main(int argc, char **argv){
 			exit(1);
 		}
 
-		//Setup and run the Solver.
-		Solver::BlockDiagonalizer solver;
+		//Setup and run the Solver. Only the eigenvalues are needed
+		//for the DOS, and single precision is enough to resolve them
+		//on the energy grid.
+		BlockSolver solver;
 		solver.setModel(model);
+		solver.setMode(BlockSolver::Mode::EigenValues);
+		solver.setPrecision(BlockSolver::Precision::Single);
+		if(cache)
+			solver.setCache(*cache);
 		solver.run();
 
 		//Setup the PropertyExtractor.
-		PropertyExtractor::BlockDiagonalizer propertyExtractor(solver);
+		BlockPropertyExtractor propertyExtractor(solver);
 		propertyExtractor.setEnergyWindow(-7, 7, 1000);
 		Property::DOS dos = propertyExtractor.calculateDOS();
 
+		//Sum the contributions from all processes.
+		reduce(dos);
+
 		//Normalize the DOS.
+		int basisSize = reduce(model.getBasisSize());
 		for(unsigned int c = 0; c < dos.getResolution(); c++)
-			dos(c) = dos(c)/model.getBasisSize();
+			dos(c) = dos(c)/basisSize;
 
 		//Smooth the DOS.
 		const double SMOOTHING_SIGMA = 0.05;
@@ -147,10 +334,17 @@ int main(int argc, char **argv){
 		dos = Smooth::gaussian(dos, SMOOTHING_SIGMA, SMOOTHING_WINDOW);
 
 		//Plot and save the result.
-		Plotter plotter;
-		plotter.plot(dos);
-		plotter.save(filenames[n]);
+		if(getRank() == 0){
+			Plotter plotter;
+			plotter.plot(dos);
+			plotter.save(filenames[n]);
+		}
 	}
 
+#ifdef USE_MPI
+	//Finalize MPI.
+	MPI_Finalize();
+#endif
+
 	return 0;
 }
@@ -0,0 +1,119 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file BulkPropertyExtractor.h
+ *  @brief Extracts properties for many Indices at once from a
+ *  Solver::Diagonalizer.
+ *
+ *  The LDOS for a set of Indices is given by the matrix product P*K, where
+ *  \f$P_{in} = |\Psi_n(i)|^2\f$ and \f$K_{ne} = \delta_{\sigma}(E_e - E_n)\f$
+ *  is a Gaussian broadened spectral kernel. Rather than looping over the
+ *  eigenstates once per Index, the Indices are divided into blocks that are
+ *  processed in parallel, and each block is contracted with the kernel using
+ *  a single call to dgemm. Only the eigenstates that contribute to the energy
+ *  window are included. If OpenBLAS or MKL is used, BLAS is restricted to a
+ *  single thread during the contraction, since the parallelism already comes
+ *  from the blocks.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef BULK_PROPERTY_EXTRACTOR
+#define BULK_PROPERTY_EXTRACTOR
+
+#include "TBTK/Array.h"
+#include "TBTK/Index.h"
+#include "TBTK/Solver/Diagonalizer.h"
+
+#include <vector>
+
+class BulkPropertyExtractor{
+public:
+	/** Constructor.
+	 *
+	 *  @param solver The Solver::Diagonalizer to extract properties from.
+	 */
+	BulkPropertyExtractor(TBTK::Solver::Diagonalizer &solver);
+
+	/** Set the energy window used for energy dependent quantities.
+	 *
+	 *  @param lowerBound The lower bound of the energy window.
+	 *  @param upperBound The upper bound of the energy window.
+	 *  @param energyResolution The number of points used to resolve the
+	 *  energy window. Must be at least two, since the end points are
+	 *  included. */
+	void setEnergyWindow(
+		double lowerBound,
+		double upperBound,
+		int energyResolution
+	);
+
+	/** Set the standard deviation of the Gaussian broadening.
+	 *
+	 *  @param broadening The broadening. */
+	void setBroadening(double broadening);
+
+	/** Calculate the LDOS for a set of Indices.
+	 *
+	 *  @param indices The Indices to calculate the LDOS for.
+	 *
+	 *  @return Array with ranges {indices.size(), energyResolution}
+	 *  containing the LDOS. */
+	TBTK::Array<double> calculateLDOS(
+		const std::vector<TBTK::Index> &indices
+	) const;
+
+	/** Calculate the density at zero temperature for a set of Indices.
+	 *
+	 *  @param indices The Indices to calculate the density for.
+	 *  @param chemicalPotential The chemical potential.
+	 *
+	 *  @return Array with range {indices.size()} containing the density.
+	 */
+	TBTK::Array<double> calculateDensity(
+		const std::vector<TBTK::Index> &indices,
+		double chemicalPotential
+	) const;
+private:
+	/** The Solver::Diagonalizer to extract properties from. */
+	TBTK::Solver::Diagonalizer &solver;
+
+	/** The energy window. */
+	double lowerBound;
+	double upperBound;
+	int energyResolution;
+
+	/** The broadening. */
+	double broadening;
+
+	/** Calculate P*K for the states in the range [firstState, lastState),
+	 *  where the kernel K is stored on column major format with
+	 *  lastState - firstState rows and numColumns columns. The result is
+	 *  stored on row major format with one row per Index. */
+	std::vector<double> contract(
+		const std::vector<TBTK::Index> &indices,
+		unsigned int firstState,
+		unsigned int lastState,
+		const std::vector<double> &kernel,
+		unsigned int numColumns
+	) const;
+};
+
+inline void BulkPropertyExtractor::setBroadening(double broadening){
+	this->broadening = broadening;
+}
+
+#endif
@@ -0,0 +1,75 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file InertiaPropertyExtractor.h
+ *  @brief Extracts properties from an InertiaSolver.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef INERTIA_PROPERTY_EXTRACTOR
+#define INERTIA_PROPERTY_EXTRACTOR
+
+#include "InertiaSolver.h"
+#include "TBTK/Array.h"
+
+#include <vector>
+
+class InertiaPropertyExtractor{
+public:
+	/** Constructor.
+	 *
+	 *  @param solver The InertiaSolver to extract properties from. */
+	InertiaPropertyExtractor(const InertiaSolver &solver);
+
+	/** Set the energy window used for energy dependent quantities.
+	 *
+	 *  @param lowerBound The lower bound of the energy window.
+	 *  @param upperBound The upper bound of the energy window.
+	 *  @param energyResolution The number of points used to resolve the
+	 *  energy window. Must be at least two, since the end points are
+	 *  included. */
+	void setEnergyWindow(
+		double lowerBound,
+		double upperBound,
+		int energyResolution
+	);
+
+	/** Calculate the integrated DOS. The energies are processed in
+	 *  parallel.
+	 *
+	 *  @return Array with range {energyResolution} containing the number
+	 *  of states below each energy. */
+	TBTK::Array<double> calculateIntegratedDOS() const;
+
+	/** Calculate the eigenvalues in the energy window using bisection.
+	 *  The eigenvalues are processed in parallel.
+	 *
+	 *  @param tolerance The accuracy of the eigenvalues.
+	 *
+	 *  @return The eigenvalues in the energy window in ascending order. */
+	std::vector<double> calculateEigenValues(double tolerance = 1e-12) const;
+private:
+	/** The InertiaSolver to extract properties from. */
+	const InertiaSolver &solver;
+
+	/** The energy window. */
+	double lowerBound;
+	double upperBound;
+	int energyResolution;
+};
+
+#endif
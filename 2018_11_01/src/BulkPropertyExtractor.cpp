@@ -0,0 +1,287 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file BulkPropertyExtractor.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "BulkPropertyExtractor.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+using namespace std;
+using namespace TBTK;
+
+//Number of Indices that are contracted with the kernel in each call to dgemm.
+static const unsigned int INDICES_PER_BLOCK = 256;
+
+//Number of standard deviations beyond which the Gaussian broadening is
+//neglected.
+static const double CUTOFF = 5;
+
+//BLAS routine for matrix-matrix multiplication.
+extern "C" void dgemm_(
+	const char *transa,
+	const char *transb,
+	const int *m,
+	const int *n,
+	const int *k,
+	const double *alpha,
+	const double *a,
+	const int *lda,
+	const double *b,
+	const int *ldb,
+	const double *beta,
+	double *c,
+	const int *ldc
+);
+
+//Functions for controlling the number of threads used by OpenBLAS and MKL.
+//They are declared weak so that they are null if another BLAS is linked.
+extern "C" int openblas_get_num_threads() __attribute__((weak));
+extern "C" void openblas_set_num_threads(int numThreads)
+	__attribute__((weak));
+extern "C" int MKL_Get_Max_Threads() __attribute__((weak));
+extern "C" void MKL_Set_Num_Threads(int numThreads) __attribute__((weak));
+
+//Restricts BLAS to a single thread while it exists and restores the previous
+//number of threads when destroyed. Used when BLAS is called from inside an
+//OpenMP parallel region, where a multithreaded BLAS would start one team of
+//threads per OpenMP thread and oversubscribe the cores.
+class SingleThreadedBLAS{
+public:
+	SingleThreadedBLAS(){
+		if(openblas_get_num_threads && openblas_set_num_threads){
+			numOpenBLASThreads = openblas_get_num_threads();
+			openblas_set_num_threads(1);
+		}
+		if(MKL_Get_Max_Threads && MKL_Set_Num_Threads){
+			numMKLThreads = MKL_Get_Max_Threads();
+			MKL_Set_Num_Threads(1);
+		}
+	}
+
+	~SingleThreadedBLAS(){
+		if(openblas_get_num_threads && openblas_set_num_threads)
+			openblas_set_num_threads(numOpenBLASThreads);
+		if(MKL_Get_Max_Threads && MKL_Set_Num_Threads)
+			MKL_Set_Num_Threads(numMKLThreads);
+	}
+private:
+	int numOpenBLASThreads;
+	int numMKLThreads;
+};
+
+BulkPropertyExtractor::BulkPropertyExtractor(
+	Solver::Diagonalizer &solver
+) :
+	solver(solver)
+{
+	lowerBound = -1;
+	upperBound = 1;
+	energyResolution = 1000;
+	broadening = 0.01;
+}
+
+void BulkPropertyExtractor::setEnergyWindow(
+	double lowerBound,
+	double upperBound,
+	int energyResolution
+){
+	TBTKAssert(
+		energyResolution >= 2,
+		"BulkPropertyExtractor::setEnergyWindow()",
+		"The energy resolution must be at least 2, but '"
+		<< energyResolution << "' was given.",
+		""
+	);
+
+	this->lowerBound = lowerBound;
+	this->upperBound = upperBound;
+	this->energyResolution = energyResolution;
+}
+
+Array<double> BulkPropertyExtractor::calculateLDOS(
+	const vector<Index> &indices
+) const{
+	const CArray<double> &eigenValues = solver.getEigenValues();
+	unsigned int basisSize = eigenValues.getSize();
+
+	//Find the states that contribute to the energy window. The
+	//eigenvalues are sorted in ascending order.
+	const double *begin = eigenValues.getData();
+	const double *end = begin + basisSize;
+	unsigned int firstState = lower_bound(
+		begin,
+		end,
+		lowerBound - CUTOFF*broadening
+	) - begin;
+	unsigned int lastState = upper_bound(
+		begin,
+		end,
+		upperBound + CUTOFF*broadening
+	) - begin;
+	unsigned int numStates = lastState - firstState;
+
+	//Setup the kernel.
+	vector<double> kernel(numStates*energyResolution);
+	double dE = (upperBound - lowerBound)/(energyResolution - 1);
+	for(int e = 0; e < energyResolution; e++){
+		double E = lowerBound + e*dE;
+		for(unsigned int n = 0; n < numStates; n++){
+			double x = (E - eigenValues[firstState + n])/broadening;
+			kernel[n + e*numStates] = exp(-x*x/2)/(
+				sqrt(2*M_PI)*broadening
+			);
+		}
+	}
+
+	vector<double> result = contract(
+		indices,
+		firstState,
+		lastState,
+		kernel,
+		energyResolution
+	);
+
+	Array<double> ldos(
+		{(unsigned int)indices.size(), (unsigned int)energyResolution}
+	);
+	copy(result.begin(), result.end(), ldos.getData());
+
+	return ldos;
+}
+
+Array<double> BulkPropertyExtractor::calculateDensity(
+	const vector<Index> &indices,
+	double chemicalPotential
+) const{
+	const CArray<double> &eigenValues = solver.getEigenValues();
+	unsigned int numOccupiedStates = upper_bound(
+		eigenValues.getData(),
+		eigenValues.getData() + eigenValues.getSize(),
+		chemicalPotential
+	) - eigenValues.getData();
+
+	vector<double> result = contract(
+		indices,
+		0,
+		numOccupiedStates,
+		vector<double>(numOccupiedStates, 1),
+		1
+	);
+
+	Array<double> density({(unsigned int)indices.size()});
+	copy(result.begin(), result.end(), density.getData());
+
+	return density;
+}
+
+vector<double> BulkPropertyExtractor::contract(
+	const vector<Index> &indices,
+	unsigned int firstState,
+	unsigned int lastState,
+	const vector<double> &kernel,
+	unsigned int numColumns
+) const{
+	const CArray<complex<double>> &eigenVectors
+		= solver.getEigenVectors();
+	unsigned int basisSize = solver.getEigenValues().getSize();
+	int numStates = lastState - firstState;
+
+	//Convert the Indices to basis indices.
+	const Model &model = solver.getModel();
+	vector<unsigned int> basisIndices(indices.size());
+	for(unsigned int n = 0; n < indices.size(); n++){
+		int basisIndex = model.getBasisIndex(indices[n]);
+		TBTKAssert(
+			basisIndex >= 0,
+			"BulkPropertyExtractor::contract()",
+			"The Index " << indices[n].toString() << " is not"
+			<< " included in the Model.",
+			""
+		);
+		basisIndices[n] = basisIndex;
+	}
+
+	vector<double> result(indices.size()*numColumns, 0);
+	if(numStates == 0)
+		return result;
+
+	//The blocks are processed in parallel, so each call to dgemm is
+	//restricted to a single thread.
+	SingleThreadedBLAS singleThreadedBLAS;
+	unsigned int numBlocks
+		= (indices.size() + INDICES_PER_BLOCK - 1)/INDICES_PER_BLOCK;
+	#pragma omp parallel for schedule(dynamic)
+	for(unsigned int block = 0; block < numBlocks; block++){
+		unsigned int firstIndex = block*INDICES_PER_BLOCK;
+		int blockSize = min(
+			INDICES_PER_BLOCK,
+			(unsigned int)indices.size() - firstIndex
+		);
+
+		//Setup the probability densities on column major format with
+		//one row per Index and one column per state.
+		vector<double> probabilities(blockSize*numStates);
+		for(int n = 0; n < numStates; n++){
+			const complex<double> *eigenVector = &eigenVectors[
+				basisSize*(firstState + n)
+			];
+			for(int i = 0; i < blockSize; i++){
+				probabilities[i + n*blockSize] = norm(
+					eigenVector[basisIndices[firstIndex + i]]
+				);
+			}
+		}
+
+		//Contract the probability densities with the kernel.
+		vector<double> blockResult(blockSize*numColumns);
+		const char transpose = 'N';
+		const int n = numColumns;
+		const double alpha = 1;
+		const double beta = 0;
+		dgemm_(
+			&transpose,
+			&transpose,
+			&blockSize,
+			&n,
+			&numStates,
+			&alpha,
+			probabilities.data(),
+			&blockSize,
+			kernel.data(),
+			&numStates,
+			&beta,
+			blockResult.data(),
+			&blockSize
+		);
+
+		//Transpose the result into the output.
+		for(int i = 0; i < blockSize; i++){
+			for(unsigned int c = 0; c < numColumns; c++){
+				result[(firstIndex + i)*numColumns + c]
+					= blockResult[i + c*blockSize];
+			}
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,96 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file InertiaPropertyExtractor.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "InertiaPropertyExtractor.h"
+#include "TBTK/TBTKMacros.h"
+
+using namespace std;
+using namespace TBTK;
+
+InertiaPropertyExtractor::InertiaPropertyExtractor(
+	const InertiaSolver &solver
+) :
+	solver(solver)
+{
+	lowerBound = -1;
+	upperBound = 1;
+	energyResolution = 1000;
+}
+
+void InertiaPropertyExtractor::setEnergyWindow(
+	double lowerBound,
+	double upperBound,
+	int energyResolution
+){
+	TBTKAssert(
+		energyResolution >= 2,
+		"InertiaPropertyExtractor::setEnergyWindow()",
+		"The energy resolution must be at least 2, but '"
+		<< energyResolution << "' was given.",
+		""
+	);
+
+	this->lowerBound = lowerBound;
+	this->upperBound = upperBound;
+	this->energyResolution = energyResolution;
+}
+
+Array<double> InertiaPropertyExtractor::calculateIntegratedDOS() const{
+	Array<double> integratedDOS({(unsigned int)energyResolution}, 0);
+	double dE = (upperBound - lowerBound)/(energyResolution - 1);
+	#pragma omp parallel for schedule(dynamic)
+	for(int e = 0; e < energyResolution; e++){
+		integratedDOS[{(unsigned int)e}]
+			= solver.getNumStatesBelow(lowerBound + e*dE);
+	}
+
+	return integratedDOS;
+}
+
+vector<double> InertiaPropertyExtractor::calculateEigenValues(
+	double tolerance
+) const{
+	unsigned int firstState = solver.getNumStatesBelow(lowerBound);
+	unsigned int lastState = solver.getNumStatesBelow(upperBound);
+
+	//Isolate eigenvalue number firstState + n by bisection. It is the
+	//smallest energy E for which more than firstState + n states are
+	//below E.
+	vector<double> eigenValues(lastState - firstState);
+	#pragma omp parallel for schedule(dynamic)
+	for(unsigned int n = 0; n < eigenValues.size(); n++){
+		double lower = lowerBound;
+		double upper = upperBound;
+		while(upper - lower > tolerance){
+			double middle = (lower + upper)/2;
+			if(middle <= lower || middle >= upper)
+				break;
+
+			if(solver.getNumStatesBelow(middle) > firstState + n)
+				upper = middle;
+			else
+				lower = middle;
+		}
+		eigenValues[n] = (lower + upper)/2;
+	}
+
+	return eigenValues;
+}
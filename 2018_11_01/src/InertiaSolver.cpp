@@ -0,0 +1,197 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file InertiaSolver.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "InertiaSolver.h"
+#include "TBTK/HoppingAmplitudeSet.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <algorithm>
+#include <complex>
+#include <cstdlib>
+#include <limits>
+
+using namespace std;
+using namespace TBTK;
+
+//LAPACK routine for reducing a Hermitian band matrix to real symmetric
+//tridiagonal form.
+extern "C" void zhbtrd_(
+	const char *vect,
+	const char *uplo,
+	const int *n,
+	const int *kd,
+	complex<double> *ab,
+	const int *ldab,
+	double *d,
+	double *e,
+	complex<double> *q,
+	const int *ldq,
+	complex<double> *work,
+	int *info
+);
+
+InertiaSolver::InertiaSolver(){
+	model = nullptr;
+	basisSize = 0;
+	bandwidth = 0;
+	lowerBound = 0;
+	upperBound = 0;
+	minPivot = numeric_limits<double>::min();
+}
+
+void InertiaSolver::run(){
+	TBTKAssert(
+		model != nullptr,
+		"InertiaSolver::run()",
+		"Model not set.",
+		"Use InertiaSolver::setModel() to set the Model."
+	);
+	const HoppingAmplitudeSet &hoppingAmplitudeSet
+		= model->getHoppingAmplitudeSet();
+	basisSize = hoppingAmplitudeSet.getBasisSize();
+
+	//Determine the bandwidth.
+	bandwidth = 0;
+	for(
+		HoppingAmplitudeSet::ConstIterator iterator
+			= hoppingAmplitudeSet.cbegin();
+		iterator != hoppingAmplitudeSet.cend();
+		++iterator
+	){
+		int row = hoppingAmplitudeSet.getBasisIndex(
+			(*iterator).getToIndex()
+		);
+		int column = hoppingAmplitudeSet.getBasisIndex(
+			(*iterator).getFromIndex()
+		);
+		bandwidth = max(bandwidth, (unsigned int)abs(row - column));
+	}
+
+	//Write the lower triangle to a band matrix on the format used by
+	//LAPACK. The element H(i, j) with i >= j is stored at
+	//j*(bandwidth + 1) + (i - j).
+	vector<complex<double>> band(basisSize*(bandwidth + 1), 0);
+	for(
+		HoppingAmplitudeSet::ConstIterator iterator
+			= hoppingAmplitudeSet.cbegin();
+		iterator != hoppingAmplitudeSet.cend();
+		++iterator
+	){
+		unsigned int row = hoppingAmplitudeSet.getBasisIndex(
+			(*iterator).getToIndex()
+		);
+		unsigned int column = hoppingAmplitudeSet.getBasisIndex(
+			(*iterator).getFromIndex()
+		);
+		if(row < column)
+			continue;
+
+		band[column*(bandwidth + 1) + (row - column)]
+			+= (*iterator).getAmplitude();
+	}
+
+	//Reduce the band matrix to tridiagonal form. The off-diagonal has
+	//basisSize - 1 elements, but one extra is allocated to keep the
+	//indexing below simple.
+	diagonal.assign(basisSize, 0);
+	vector<double> offDiagonal(basisSize, 0);
+	if(basisSize != 0){
+		const char vect = 'N';
+		const char uplo = 'L';
+		const int n = basisSize;
+		const int kd = bandwidth;
+		const int ldab = bandwidth + 1;
+		const int ldq = 1;
+		complex<double> q;
+		vector<complex<double>> work(basisSize);
+		int info;
+		zhbtrd_(
+			&vect,
+			&uplo,
+			&n,
+			&kd,
+			band.data(),
+			&ldab,
+			diagonal.data(),
+			offDiagonal.data(),
+			&q,
+			&ldq,
+			work.data(),
+			&info
+		);
+		TBTKAssert(
+			info == 0,
+			"InertiaSolver::run()",
+			"Reduction to tridiagonal form failed with error code "
+			<< info << ".",
+			""
+		);
+	}
+
+	//Calculate bounds for the spectrum using the Gershgorin circle
+	//theorem, and the smallest allowed pivot as in the LAPACK routine
+	//dstebz.
+	offDiagonalSquared.assign(basisSize == 0 ? 0 : basisSize - 1, 0);
+	double maxOffDiagonalSquared = 0;
+	for(unsigned int i = 0; i < offDiagonalSquared.size(); i++){
+		offDiagonalSquared[i] = offDiagonal[i]*offDiagonal[i];
+		maxOffDiagonalSquared = max(
+			maxOffDiagonalSquared,
+			offDiagonalSquared[i]
+		);
+	}
+	minPivot = numeric_limits<double>::min()*max(
+		1.,
+		maxOffDiagonalSquared
+	);
+	for(unsigned int i = 0; i < basisSize; i++){
+		double radius = 0;
+		if(i > 0)
+			radius += abs(offDiagonal[i-1]);
+		if(i + 1 < basisSize)
+			radius += abs(offDiagonal[i]);
+		if(i == 0 || diagonal[i] - radius < lowerBound)
+			lowerBound = diagonal[i] - radius;
+		if(i == 0 || diagonal[i] + radius > upperBound)
+			upperBound = diagonal[i] + radius;
+	}
+}
+
+unsigned int InertiaSolver::getNumStatesBelow(double energy) const{
+	//Calculate the pivots of T - E = LDL^T, where T is tridiagonal. The
+	//pivots are given by the recursion
+	//d_i = T(i, i) - E - T(i, i-1)^2/d_{i-1}. A pivot that is smaller than
+	//minPivot is replaced by -minPivot, which is known to give the
+	//correct count for a slightly perturbed T.
+	unsigned int numNegative = 0;
+	double pivot = 1;
+	for(unsigned int i = 0; i < basisSize; i++){
+		pivot = diagonal[i] - energy - (
+			i == 0 ? 0 : offDiagonalSquared[i-1]/pivot
+		);
+		if(abs(pivot) < minPivot)
+			pivot = -minPivot;
+		if(pivot < 0)
+			numNegative++;
+	}
+
+	return numNegative;
+}
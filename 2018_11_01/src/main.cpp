@@ -13,6 +13,9 @@
  * limitations under the License.
  */
 
+#include "BulkPropertyExtractor.h"
+#include "InertiaPropertyExtractor.h"
+#include "InertiaSolver.h"
 #include "TBTK/AbstractIndexFilter.h"
 #include "TBTK/Model.h"
 #include "TBTK/PropertyExtractor/Diagonalizer.h"
@@ -128,5 +131,78 @@ int main(int argc, char **argv){
 	plotter.plot(probabilityDensity);
 	plotter.save("figures/ProbabilityDensity.png");
 
+	//Collect the Indices of all sites in the annulus.
+	vector<Index> indices;
+	for(unsigned int x = 0; x < SIZE_X; x++)
+		for(unsigned int y = 0; y < SIZE_Y; y++)
+			if(filter.isIncluded({x, y}))
+				indices.push_back({x, y});
+
+	//Calculate the LDOS for all sites in the annulus in one pass.
+	const double LOWER_BOUND = -5;
+	const double UPPER_BOUND = 5;
+	const int ENERGY_RESOLUTION = 201;
+	BulkPropertyExtractor bulkPropertyExtractor(solver);
+	bulkPropertyExtractor.setEnergyWindow(
+		LOWER_BOUND,
+		UPPER_BOUND,
+		ENERGY_RESOLUTION
+	);
+	bulkPropertyExtractor.setBroadening(0.05);
+	Array<double> ldos = bulkPropertyExtractor.calculateLDOS(indices);
+
+	//Plot the LDOS at the energy of the given state, unless the energy is
+	//outside of the energy window.
+	int energyIndex = (int)round(
+		(propertyExtractor.getEigenValue(state) - LOWER_BOUND)
+		*(ENERGY_RESOLUTION - 1)/(UPPER_BOUND - LOWER_BOUND)
+	);
+	if(energyIndex >= 0 && energyIndex < ENERGY_RESOLUTION){
+		Array<double> ldosMap({SIZE_X, SIZE_Y}, 0);
+		for(unsigned int n = 0; n < indices.size(); n++){
+			unsigned int x = indices[n][0];
+			unsigned int y = indices[n][1];
+			ldosMap[{x, y}] = ldos[{n, (unsigned int)energyIndex}];
+		}
+		plotter.clear();
+		plotter.plot(ldosMap);
+		plotter.save("figures/LDOS.png");
+	}
+	else{
+		Streams::out << "The energy of state " << state << " is outside"
+			<< " of the energy window [" << LOWER_BOUND << ", "
+			<< UPPER_BOUND << "], skipping the LDOS plot.\n";
+	}
+
+	//Calculate the number of states below each energy without
+	//diagonalizing the Hamiltonian.
+	InertiaSolver inertiaSolver;
+	inertiaSolver.setModel(model);
+	inertiaSolver.run();
+	InertiaPropertyExtractor inertiaPropertyExtractor(inertiaSolver);
+	inertiaPropertyExtractor.setEnergyWindow(
+		LOWER_BOUND,
+		UPPER_BOUND,
+		ENERGY_RESOLUTION
+	);
+	Array<double> integratedDOS
+		= inertiaPropertyExtractor.calculateIntegratedDOS();
+
+	//Plot the integrated DOS.
+	plotter.clear();
+	plotter.setLabelX("Energy");
+	plotter.setLabelY("Number of states");
+	vector<double> energies;
+	vector<double> numStates;
+	for(unsigned int e = 0; e < ENERGY_RESOLUTION; e++){
+		energies.push_back(
+			LOWER_BOUND
+			+ e*(UPPER_BOUND - LOWER_BOUND)/(ENERGY_RESOLUTION - 1)
+		);
+		numStates.push_back(integratedDOS[{e}]);
+	}
+	plotter.plot(energies, numStates, {{"color", "black"}});
+	plotter.save("figures/IntegratedDOS.png");
+
 	return 0;
 }
@@ -0,0 +1,143 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file DenseIndexMap.h
+ *  @brief Arithmetic mapping between physical indices and basis indices for
+ *  lattices.
+ *
+ *  HoppingAmplitudeSet::getBasisIndex() walks the index tree for every call.
+ *  When all Indices have the same number of subindices and fill a box, the
+ *  basis index is instead given by the position in the box, which can be
+ *  calculated using strides. If only some sites in the box are included, for
+ *  example because an IndexFilter has been used, a bitmap of the included
+ *  sites is used together with precomputed ranks to find the basis index in
+ *  constant time. The position of each included site is also stored, so
+ *  that the physical Index for a given basis index is found in constant
+ *  time as well.
+ *
+ *  If the Indices do not have this structure, the DenseIndexMap falls back
+ *  to the HoppingAmplitudeSet.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef DENSE_INDEX_MAP
+#define DENSE_INDEX_MAP
+
+#include "TBTK/HoppingAmplitudeSet.h"
+#include "TBTK/Index.h"
+
+#include <cstdint>
+#include <vector>
+
+class DenseIndexMap{
+public:
+	/** Constructor.
+	 *
+	 *  @param hoppingAmplitudeSet The HoppingAmplitudeSet to create the
+	 *  mapping for. Must be constructed and outlive the DenseIndexMap. */
+	DenseIndexMap(const TBTK::HoppingAmplitudeSet &hoppingAmplitudeSet);
+
+	/** Get whether the arithmetic mapping is used.
+	 *
+	 *  @return True if the Indices form a dense, possibly filtered, box. */
+	bool getIsDense() const;
+
+	/** Get the basis index for a given physical Index.
+	 *
+	 *  @param index The physical Index.
+	 *
+	 *  @return The basis index, or -1 if the Index is not in the basis. */
+	int getBasisIndex(const TBTK::Index &index) const;
+
+	/** Get the physical Index for a given basis index.
+	 *
+	 *  @param basisIndex The basis index.
+	 *
+	 *  @return The physical Index. */
+	TBTK::Index getPhysicalIndex(int basisIndex) const;
+private:
+	/** The HoppingAmplitudeSet to fall back to. */
+	const TBTK::HoppingAmplitudeSet &hoppingAmplitudeSet;
+
+	/** Flag indicating whether the arithmetic mapping is used. */
+	bool isDense;
+
+	/** Flag indicating whether only some of the sites in the box are
+	 *  included. */
+	bool isFiltered;
+
+	/** The smallest value and the range of each subindex. */
+	std::vector<int> minimums;
+	std::vector<int> ranges;
+
+	/** Strides for calculating the position in the box. The last
+	 *  subindex runs fastest. */
+	std::vector<unsigned long> strides;
+
+	/** Bitmap with one bit per position in the box, set for the
+	 *  included sites. */
+	std::vector<uint64_t> bitmap;
+
+	/** The number of included sites before each word in the bitmap. */
+	std::vector<unsigned int> ranks;
+
+	/** The position in the box of each included site, indexed by basis
+	 *  index. */
+	std::vector<unsigned long> positions;
+
+	/** Get the position in the box for a given Index. Returns -1 if the
+	 *  Index is outside of the box. */
+	long getPosition(const TBTK::Index &index) const;
+};
+
+inline bool DenseIndexMap::getIsDense() const{
+	return isDense;
+}
+
+inline long DenseIndexMap::getPosition(const TBTK::Index &index) const{
+	if(index.getSize() != ranges.size())
+		return -1;
+
+	long position = 0;
+	for(unsigned int n = 0; n < ranges.size(); n++){
+		int subindex = index[n] - minimums[n];
+		if(subindex < 0 || subindex >= ranges[n])
+			return -1;
+		position += subindex*strides[n];
+	}
+
+	return position;
+}
+
+inline int DenseIndexMap::getBasisIndex(const TBTK::Index &index) const{
+	if(!isDense)
+		return hoppingAmplitudeSet.getBasisIndex(index);
+
+	long position = getPosition(index);
+	if(position < 0 || !isFiltered)
+		return position;
+
+	uint64_t word = bitmap[position/64];
+	unsigned int bit = position%64;
+	if(((word >> bit) & 1) == 0)
+		return -1;
+
+	return ranks[position/64]
+		+ __builtin_popcountll(word & ((uint64_t(1) << bit) - 1));
+}
+
+#endif
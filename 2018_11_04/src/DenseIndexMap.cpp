@@ -0,0 +1,132 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file DenseIndexMap.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "DenseIndexMap.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace TBTK;
+
+//The bitmap is only used if the box contains at most this many sites per
+//included site.
+static const unsigned int MAX_SITES_PER_INCLUDED_SITE = 64;
+
+DenseIndexMap::DenseIndexMap(
+	const HoppingAmplitudeSet &hoppingAmplitudeSet
+) :
+	hoppingAmplitudeSet(hoppingAmplitudeSet)
+{
+	isDense = false;
+	isFiltered = false;
+
+	unsigned int basisSize = hoppingAmplitudeSet.getBasisSize();
+	if(basisSize == 0)
+		return;
+
+	//Find the bounding box. All Indices need to have the same number of
+	//subindices.
+	Index index = hoppingAmplitudeSet.getPhysicalIndex(0);
+	unsigned int numSubindices = index.getSize();
+	vector<int> maximums(numSubindices);
+	minimums.resize(numSubindices);
+	for(unsigned int n = 0; n < numSubindices; n++){
+		minimums[n] = index[n];
+		maximums[n] = index[n];
+	}
+	for(unsigned int b = 1; b < basisSize; b++){
+		index = hoppingAmplitudeSet.getPhysicalIndex(b);
+		if(index.getSize() != numSubindices)
+			return;
+
+		for(unsigned int n = 0; n < numSubindices; n++){
+			minimums[n] = min(minimums[n], index[n]);
+			maximums[n] = max(maximums[n], index[n]);
+		}
+	}
+
+	//Calculate the strides and the number of sites in the box.
+	ranges.resize(numSubindices);
+	strides.resize(numSubindices);
+	unsigned long boxSize = 1;
+	for(int n = numSubindices - 1; n >= 0; n--){
+		ranges[n] = maximums[n] - minimums[n] + 1;
+		strides[n] = boxSize;
+		boxSize *= ranges[n];
+	}
+	if(boxSize > (unsigned long)MAX_SITES_PER_INCLUDED_SITE*basisSize)
+		return;
+
+	//Mark the included sites in the bitmap. The arithmetic mapping is
+	//only valid if the basis indices are ordered in the same way as the
+	//positions in the box.
+	bitmap.assign((boxSize + 63)/64, 0);
+	positions.resize(basisSize);
+	long previousPosition = -1;
+	for(unsigned int b = 0; b < basisSize; b++){
+		long position = getPosition(
+			hoppingAmplitudeSet.getPhysicalIndex(b)
+		);
+		if(position <= previousPosition)
+			return;
+
+		bitmap[position/64] |= uint64_t(1) << (position%64);
+		positions[b] = position;
+		previousPosition = position;
+	}
+
+	//Calculate the ranks. Neither the bitmap nor the positions are needed
+	//if all sites in the box are included.
+	if(boxSize == basisSize){
+		bitmap.clear();
+		positions.clear();
+	}
+	else{
+		isFiltered = true;
+		ranks.resize(bitmap.size());
+		unsigned int rank = 0;
+		for(unsigned int n = 0; n < bitmap.size(); n++){
+			ranks[n] = rank;
+			rank += __builtin_popcountll(bitmap[n]);
+		}
+	}
+
+	isDense = true;
+}
+
+Index DenseIndexMap::getPhysicalIndex(int basisIndex) const{
+	if(!isDense)
+		return hoppingAmplitudeSet.getPhysicalIndex(basisIndex);
+
+	//Find the position of the site with the given basis index.
+	unsigned long position = basisIndex;
+	if(isFiltered)
+		position = positions[basisIndex];
+
+	//Convert the position to an Index.
+	Index index;
+	for(unsigned int n = 0; n < ranges.size(); n++){
+		index.pushBack(minimums[n] + position/strides[n]);
+		position %= strides[n];
+	}
+
+	return index;
+}
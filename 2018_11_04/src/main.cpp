@@ -13,13 +13,16 @@
  * limitations under the License.
  */
 
-#include "TBTK/Array.h"
+#include "DenseIndexMap.h"
 #include "TBTK/Model.h"
 #include "TBTK/PropertyExtractor/Diagonalizer.h"
 #include "TBTK/Solver/Diagonalizer.h"
 #include "TBTK/Streams.h"
 #include "TBTK/TBTK.h"
 
+#include <complex>
+#include <vector>
+
 using namespace std;
 using namespace TBTK;
 
@@ -65,9 +68,17 @@ int main(int argc, char **argv){
 		= model.getHoppingAmplitudeSet();
 	unsigned int basisSize = hoppingAmplitudeSet.getBasisSize();
 
+	//Create a DenseIndexMap for converting physical indices to linear
+	//indices. Since the Indices form a rectangular lattice, the
+	//conversion is done arithmetically instead of by a tree search.
+	DenseIndexMap indexMap(hoppingAmplitudeSet);
+
 	//Initialize the Hamiltonian on a format most suitable for the
-	//algorithm at hand.
-	Array<complex<double>> hamiltonian({basisSize, basisSize}, 0.);
+	//algorithm at hand. Since the Hamiltonian is Hermitian, only the upper
+	//triangle is stored. The element (row, column) with row <= column is
+	//stored at row + column*(column + 1)/2, which is the packed format
+	//used by LAPACK routines such as zhpev.
+	vector<complex<double>> hamiltonian(basisSize*(basisSize + 1)/2, 0.);
 
 	//Iterate over the HoppingAmplitudes.
 	for(
@@ -83,21 +94,35 @@ int main(int argc, char **argv){
 		const Index &fromIndex = (*iterator).getFromIndex();
 
 		//Convert the physical indices to linear indices.
-		unsigned int row = hoppingAmplitudeSet.getBasisIndex(toIndex);
-		unsigned int column = hoppingAmplitudeSet.getBasisIndex(
-			fromIndex
-		);
+		unsigned int row = indexMap.getBasisIndex(toIndex);
+		unsigned int column = indexMap.getBasisIndex(fromIndex);
+
+		//Skip the lower triangle. These elements are the Hermitian
+		//conjugates of elements in the upper triangle.
+		if(row > column)
+			continue;
 
 		//Write the amplitude to the Hamiltonian that will be used in
 		//this algorithm.
-		hamiltonian[{row, column}] += amplitude;
+		hamiltonian[row + column*(column + 1)/2] += amplitude;
 	}
 
-	//Print the Hamiltonian.
+	//Print the Hamiltonian. The lower triangle is obtained from the upper
+	//triangle by complex conjugation.
 	for(unsigned int row = 0; row < basisSize; row++){
 		for(unsigned int column = 0; column < basisSize; column++){
-			Streams::out << real(hamiltonian[{row, column}])
-				<< "\t";
+			complex<double> element;
+			if(row <= column){
+				element = hamiltonian[
+					row + column*(column + 1)/2
+				];
+			}
+			else{
+				element = conj(
+					hamiltonian[column + row*(row + 1)/2]
+				);
+			}
+			Streams::out << real(element) << "\t";
 		}
 		Streams::out << "\n";
 	}
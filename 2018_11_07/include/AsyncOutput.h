@@ -0,0 +1,121 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file AsyncOutput.h
+ *  @brief Writes results and renders figures on a background thread.
+ *
+ *  Results passed to the AsyncOutput are copied and queued, and a
+ *  background thread writes them to a binary file in the order they were
+ *  queued. Figures are rendered by the same thread, so the calculation never
+ *  waits for the file system or for matplotlib.
+ *
+ *  The embedded Python interpreter that matplotlib runs in is initialized
+ *  on the thread that creates the AsyncOutput, and is finalized on the same
+ *  thread when the program exits. The background thread holds the global
+ *  interpreter lock while it renders a figure, and the lock is handed back
+ *  to the creating thread when the AsyncOutput is destroyed. The
+ *  AsyncOutput should therefore be created and destroyed on the main
+ *  thread, before main() returns, and no other thread may use Python while
+ *  it exists.
+ *
+ *  The file starts with the unsigned int MAGIC, followed by one record per
+ *  result. Each record starts with the length of the name as an unsigned
+ *  int, the name, and the type of the result as an unsigned int. An Array
+ *  (type 0) is then stored as the number of ranges, the ranges as unsigned
+ *  ints, and the data as doubles.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef ASYNC_OUTPUT
+#define ASYNC_OUTPUT
+
+#include "TBTK/Array.h"
+
+#include <Python.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+
+class AsyncOutput{
+public:
+	/** Constructor.
+	 *
+	 *  @param filename The file to write the results to. */
+	AsyncOutput(const std::string &filename);
+
+	/** Destructor. Waits for all queued tasks to finish and joins the
+	 *  background thread. */
+	~AsyncOutput();
+
+	/** Queue an Array to be written to the file.
+	 *
+	 *  @param name The name to store the Array under.
+	 *  @param array The Array to write. */
+	void write(const std::string &name, const TBTK::Array<double> &array);
+
+	/** Queue a figure to be rendered on the background thread. The
+	 *  function should only use data that it has captured by value. The
+	 *  global interpreter lock is held while the function executes.
+	 *
+	 *  @param render Function that renders and saves the figure. */
+	void plot(const std::function<void()> &render);
+
+	/** Wait until all queued tasks have finished. */
+	void flush();
+private:
+	/** The file that the results are written to. */
+	FILE *file;
+
+	/** Queued tasks. */
+	std::queue<std::function<void()>> tasks;
+
+	/** Flag indicating whether a task is executing. */
+	bool isBusy;
+
+	/** Flag indicating that the background thread should finish. */
+	bool isDone;
+
+	/** Mutex and condition variable protecting the queue. */
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+
+	/** The background thread. */
+	std::thread worker;
+
+	/** State of the thread that created the AsyncOutput, saved while
+	 *  the background thread is allowed to use Python. */
+	PyThreadState *mainThreadState;
+
+	/** Queue a task. */
+	void enqueue(const std::function<void()> &task);
+
+	/** Execute queued tasks until the AsyncOutput is destroyed. */
+	void run();
+
+	/** Write a record header. */
+	void writeHeader(const std::string &name, unsigned int type);
+
+	/** Write raw data to the file. */
+	void writeData(const void *data, size_t size);
+};
+
+#endif
@@ -0,0 +1,180 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file ChebyshevTimePropagator.h
+ *  @brief Propagates a state in time using a Chebyshev expansion.
+ *
+ *  The time evolution operator for a time step dt is expanded as
+ *  \f$e^{-iH dt} = e^{-iE_c dt}\sum_k (2 - \delta_{k0})(-i)^k J_k(a dt)
+ *  T_k(\tilde{H})\f$, where \f$\tilde{H} = (H - E_c)/a\f$ is the
+ *  Hamiltonian scaled to the interval [-1, 1], \f$J_k\f$ are Bessel
+ *  functions of the first kind, and \f$T_k\f$ are Chebyshev polynomials.
+ *  The Bessel functions decay rapidly once k exceeds a*dt, which makes the
+ *  expansion accurate to machine precision after a few more terms than
+ *  that. Each term only requires one sparse matrix-vector multiplication,
+ *  which makes the cost of a time step O(N) for N sites.
+ *
+ *  If the Model contains HoppingAmplitudes that are defined through
+ *  callbacks that depend on time, the ChebyshevTimePropagator can be set
+ *  to be time dependent. The values of the Hamiltonian are then extracted
+ *  from the Model again before every time step, which reevaluates the
+ *  callbacks. The HoppingAmplitudes themselves must not change. The
+ *  callbacks should read the time from getHamiltonianTime(), which is the
+ *  midpoint of the current time step. The Hamiltonian is held constant at
+ *  this value during the step, which is the exponential midpoint rule. The
+ *  error is of order dt^3 per step, proportional to how fast H changes, so
+ *  the time step has to be small compared to the time scale of the
+ *  callbacks even though the expansion itself is exact for any dt.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef CHEBYSHEV_TIME_PROPAGATOR
+#define CHEBYSHEV_TIME_PROPAGATOR
+
+#include "SparseHamiltonian.h"
+#include "TBTK/Model.h"
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+class ChebyshevTimePropagator{
+public:
+	/** Constructor. */
+	ChebyshevTimePropagator();
+
+	/** Set the Model to propagate the state with.
+	 *
+	 *  @param model The Model. */
+	void setModel(const TBTK::Model &model);
+
+	/** Set the time step. Only forward propagation is supported, so the
+	 *  time step has to be positive.
+	 *
+	 *  @param timeStep The time step. */
+	void setTimeStep(double timeStep);
+
+	/** Set whether the Hamiltonian depends on time. If true, the values
+	 *  of the Hamiltonian are extracted from the Model before every time
+	 *  step.
+	 *  Defaults to false.
+	 *
+	 *  @param isTimeDependent Flag indicating whether the Hamiltonian
+	 *  depends on time. */
+	void setTimeDependent(bool isTimeDependent);
+
+	/** Set the state and reset the time to zero.
+	 *
+	 *  @param state The amplitudes of the state in the basis of the
+	 *  Model. */
+	void setState(const std::vector<std::complex<double>> &state);
+
+	/** Get the state.
+	 *
+	 *  @return The amplitudes of the state in the basis of the Model. */
+	const std::vector<std::complex<double>>& getState() const;
+
+	/** Get the time.
+	 *
+	 *  @return The time that the state has been propagated. */
+	double getTime() const;
+
+	/** Get the time at which the Hamiltonian is evaluated. Callbacks
+	 *  that depend on time should use this time.
+	 *
+	 *  @return The midpoint of the current time step. */
+	double getHamiltonianTime() const;
+
+	/** Propagate the state one time step. */
+	void step();
+private:
+	/** The Model. */
+	const TBTK::Model *model;
+
+	/** The time step. */
+	double timeStep;
+
+	/** Flag indicating whether the Hamiltonian depends on time. */
+	bool isTimeDependent;
+
+	/** The time. */
+	double time;
+
+	/** The time at which the Hamiltonian is evaluated. */
+	double hamiltonianTime;
+
+	/** The state. */
+	std::vector<std::complex<double>> state;
+
+	/** The Hamiltonian. */
+	std::unique_ptr<SparseHamiltonian> hamiltonian;
+
+	/** The center and half width of the spectrum. */
+	double center;
+	double halfWidth;
+
+	/** The expansion coefficients for a single time step. */
+	std::vector<std::complex<double>> coefficients;
+
+	/** Work vectors for the Chebyshev recursion, kept between the time
+	 *  steps to avoid reallocating them. */
+	std::vector<std::complex<double>> previous;
+	std::vector<std::complex<double>> current;
+	std::vector<std::complex<double>> next;
+	std::vector<std::complex<double>> result;
+
+	/** Extract the Hamiltonian from the Model and calculate the expansion
+	 *  coefficients. */
+	void update();
+
+	/** Calculate the Bessel functions \f$J_k(x)\f$ using backward
+	 *  recurrence. Only the Bessel functions up to the last one that is
+	 *  larger than the machine precision are returned. The argument x
+	 *  has to be non-negative. */
+	static std::vector<double> calculateBesselFunctions(double x);
+};
+
+inline void ChebyshevTimePropagator::setModel(const TBTK::Model &model){
+	this->model = &model;
+	hamiltonian.reset();
+}
+
+inline void ChebyshevTimePropagator::setTimeDependent(bool isTimeDependent){
+	this->isTimeDependent = isTimeDependent;
+}
+
+inline void ChebyshevTimePropagator::setState(
+	const std::vector<std::complex<double>> &state
+){
+	this->state = state;
+	time = 0;
+}
+
+inline const std::vector<std::complex<double>>&
+ChebyshevTimePropagator::getState() const{
+	return state;
+}
+
+inline double ChebyshevTimePropagator::getTime() const{
+	return time;
+}
+
+inline double ChebyshevTimePropagator::getHamiltonianTime() const{
+	return hamiltonianTime;
+}
+
+#endif
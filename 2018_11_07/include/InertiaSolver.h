@@ -0,0 +1,133 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file InertiaSolver.h
+ *  @brief Counts the number of eigenvalues below a given energy without
+ *  diagonalizing the Hamiltonian.
+ *
+ *  By Sylvester's law of inertia, the number of eigenvalues of H that are
+ *  smaller than E is equal to the number of negative entries in D, where
+ *  \f$H - E = LDL^{\dagger}\f$. Without pivoting, this factorization is
+ *  only stable when H - E is tridiagonal. The InertiaSolver therefore first
+ *  reduces the Hamiltonian, stored as a band matrix, to a real symmetric
+ *  tridiagonal matrix T = Q^{\dagger}HQ using the LAPACK routine zhbtrd.
+ *  This is a unitary similarity transformation, so T has the same
+ *  eigenvalues as H. The number of eigenvalues below E is then given by the
+ *  Sturm sequence of T - E, computed as in LAPACK's bisection routines.
+ *
+ *  The reduction costs O(N^2*b) for a basis size N and a bandwidth b and is
+ *  done once in run(). Each count then costs O(N). For a one-dimensional
+ *  chain, b = 1 and the Hamiltonian already is tridiagonal.
+ *
+ *  The bandwidth is determined by the ordering of the basis. For a
+ *  rectangular lattice with Indices {x, y}, it is given by the extent of the
+ *  lattice along the y-direction.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef INERTIA_SOLVER
+#define INERTIA_SOLVER
+
+#include "TBTK/Model.h"
+
+#include <vector>
+
+class InertiaSolver{
+public:
+	/** Constructor. */
+	InertiaSolver();
+
+	/** Set the Model to solve.
+	 *
+	 *  @param model The Model to solve. */
+	void setModel(const TBTK::Model &model);
+
+	/** Extract the Hamiltonian from the Model. Needs to be called again
+	 *  if the Model contains HoppingAmplitudes with callbacks whose
+	 *  values have changed. */
+	void run();
+
+	/** Get the basis size.
+	 *
+	 *  @return The basis size. */
+	unsigned int getBasisSize() const;
+
+	/** Get the bandwidth of the Hamiltonian.
+	 *
+	 *  @return The number of non-zero subdiagonals. */
+	unsigned int getBandwidth() const;
+
+	/** Get the number of eigenvalues that are smaller than a given
+	 *  energy.
+	 *
+	 *  @param energy The energy.
+	 *
+	 *  @return The number of eigenvalues smaller than the energy. */
+	unsigned int getNumStatesBelow(double energy) const;
+
+	/** Get lower and upper bounds for the spectrum.
+	 *
+	 *  @param lowerBound Set to a lower bound for the spectrum.
+	 *  @param upperBound Set to an upper bound for the spectrum. */
+	void getSpectralBounds(double &lowerBound, double &upperBound) const;
+private:
+	/** The Model to solve. */
+	const TBTK::Model *model;
+
+	/** The basis size. */
+	unsigned int basisSize;
+
+	/** The bandwidth. */
+	unsigned int bandwidth;
+
+	/** Bounds for the spectrum. */
+	double lowerBound;
+	double upperBound;
+
+	/** The diagonal of the tridiagonal matrix. */
+	std::vector<double> diagonal;
+
+	/** The squares of the off-diagonal elements of the tridiagonal
+	 *  matrix. */
+	std::vector<double> offDiagonalSquared;
+
+	/** Pivots smaller than this in the Sturm sequence are replaced by
+	 *  -minPivot. */
+	double minPivot;
+};
+
+inline void InertiaSolver::setModel(const TBTK::Model &model){
+	this->model = &model;
+}
+
+inline unsigned int InertiaSolver::getBasisSize() const{
+	return basisSize;
+}
+
+inline unsigned int InertiaSolver::getBandwidth() const{
+	return bandwidth;
+}
+
+inline void InertiaSolver::getSpectralBounds(
+	double &lowerBound,
+	double &upperBound
+) const{
+	lowerBound = this->lowerBound;
+	upperBound = this->upperBound;
+}
+
+#endif
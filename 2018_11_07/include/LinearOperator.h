@@ -0,0 +1,62 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file LinearOperator.h
+ *  @brief Base class for Hamiltonians that are only accessed through their
+ *  action on vectors.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef LINEAR_OPERATOR
+#define LINEAR_OPERATOR
+
+#include <complex>
+
+class LinearOperator{
+public:
+	/** Destructor. */
+	virtual ~LinearOperator(){};
+
+	/** Get the size of the vectors that the operator acts on.
+	 *
+	 *  @return The basis size. */
+	virtual unsigned int getBasisSize() const = 0;
+
+	/** Get bounds for the spectrum of the operator.
+	 *
+	 *  @param lowerBound Set to a lower bound for the spectrum.
+	 *  @param upperBound Set to an upper bound for the spectrum. */
+	virtual void getSpectralBounds(
+		double &lowerBound,
+		double &upperBound
+	) const = 0;
+
+	/** Calculate \f$out = scale\cdot(H - shift)\cdot in\f$.
+	 *
+	 *  @param in The vector to act on.
+	 *  @param out The vector to write the result to.
+	 *  @param scale Factor to multiply the result by.
+	 *  @param shift Shift of the diagonal. */
+	virtual void apply(
+		const std::complex<double> *in,
+		std::complex<double> *out,
+		double scale,
+		double shift
+	) const = 0;
+};
+
+#endif
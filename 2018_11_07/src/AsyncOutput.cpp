@@ -0,0 +1,152 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file AsyncOutput.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "AsyncOutput.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <vector>
+
+using namespace std;
+using namespace TBTK;
+
+//Identifies the file format.
+static const unsigned int MAGIC = 0x4153594E;
+
+//Types of the stored results.
+static const unsigned int TYPE_ARRAY = 0;
+
+AsyncOutput::AsyncOutput(const string &filename){
+	file = fopen(filename.c_str(), "wb");
+	TBTKAssert(
+		file != nullptr,
+		"AsyncOutput::AsyncOutput()",
+		"Unable to open '" << filename << "'.",
+		""
+	);
+	writeData(&MAGIC, sizeof(MAGIC));
+
+	//Initialize Python on this thread, so that matplotlib finalizes it on
+	//the same thread at exit, and release the global interpreter lock so
+	//that the background thread can render the figures.
+	if(!Py_IsInitialized())
+		Py_Initialize();
+#if PY_VERSION_HEX < 0x03070000
+	PyEval_InitThreads();
+#endif
+	mainThreadState = PyEval_SaveThread();
+
+	isBusy = false;
+	isDone = false;
+	worker = thread(&AsyncOutput::run, this);
+}
+
+AsyncOutput::~AsyncOutput(){
+	{
+		lock_guard<mutex> lock(queueMutex);
+		isDone = true;
+	}
+	queueCondition.notify_all();
+	worker.join();
+
+	//Take back the global interpreter lock for the thread that created
+	//the AsyncOutput.
+	PyEval_RestoreThread(mainThreadState);
+
+	fclose(file);
+}
+
+void AsyncOutput::write(const string &name, const Array<double> &array){
+	enqueue([this, name, array](){
+		writeHeader(name, TYPE_ARRAY);
+
+		const vector<unsigned int> &ranges = array.getRanges();
+		unsigned int numRanges = ranges.size();
+		writeData(&numRanges, sizeof(numRanges));
+		writeData(ranges.data(), ranges.size()*sizeof(unsigned int));
+		writeData(array.getData(), array.getSize()*sizeof(double));
+	});
+}
+
+void AsyncOutput::plot(const function<void()> &render){
+	enqueue([render](){
+		PyGILState_STATE state = PyGILState_Ensure();
+		render();
+		PyGILState_Release(state);
+	});
+}
+
+void AsyncOutput::flush(){
+	unique_lock<mutex> lock(queueMutex);
+	queueCondition.wait(lock, [this](){
+		return tasks.empty() && !isBusy;
+	});
+	fflush(file);
+}
+
+void AsyncOutput::enqueue(const function<void()> &task){
+	{
+		lock_guard<mutex> lock(queueMutex);
+		tasks.push(task);
+	}
+	queueCondition.notify_all();
+}
+
+void AsyncOutput::run(){
+	while(true){
+		function<void()> task;
+		{
+			unique_lock<mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this](){
+				return !tasks.empty() || isDone;
+			});
+			if(tasks.empty())
+				return;
+
+			task = tasks.front();
+			tasks.pop();
+			isBusy = true;
+		}
+
+		task();
+
+		{
+			lock_guard<mutex> lock(queueMutex);
+			isBusy = false;
+		}
+		queueCondition.notify_all();
+	}
+}
+
+void AsyncOutput::writeHeader(const string &name, unsigned int type){
+	unsigned int nameLength = name.size();
+	writeData(&nameLength, sizeof(nameLength));
+	writeData(name.data(), nameLength);
+	writeData(&type, sizeof(type));
+}
+
+void AsyncOutput::writeData(const void *data, size_t size){
+	TBTKAssert(
+		fwrite(data, 1, size, file) == size,
+		"AsyncOutput::writeData()",
+		"Failed to write to file.",
+		""
+	);
+}
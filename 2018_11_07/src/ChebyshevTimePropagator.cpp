@@ -0,0 +1,191 @@
+/* Copyright 2018 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file ChebyshevTimePropagator.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "ChebyshevTimePropagator.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace std;
+using namespace TBTK;
+
+//Margin that keeps the scaled spectrum strictly inside [-1, 1].
+static const double SPECTRAL_MARGIN = 0.01;
+
+//Bessel functions smaller than this are dropped from the expansion.
+static const double TOLERANCE = numeric_limits<double>::epsilon();
+
+//Values above which the backward recurrence is rescaled to avoid overflow.
+static const double RESCALE_THRESHOLD = 1e250;
+
+ChebyshevTimePropagator::ChebyshevTimePropagator(){
+	model = nullptr;
+	timeStep = 1;
+	isTimeDependent = false;
+	time = 0;
+	hamiltonianTime = 0;
+	center = 0;
+	halfWidth = 1;
+}
+
+void ChebyshevTimePropagator::setTimeStep(double timeStep){
+	TBTKAssert(
+		timeStep > 0,
+		"ChebyshevTimePropagator::setTimeStep()",
+		"The time step must be positive, but '" << timeStep << "' was"
+		<< " given.",
+		""
+	);
+
+	this->timeStep = timeStep;
+	hamiltonian.reset();
+}
+
+void ChebyshevTimePropagator::step(){
+	TBTKAssert(
+		model != nullptr,
+		"ChebyshevTimePropagator::step()",
+		"Model not set.",
+		"Use ChebyshevTimePropagator::setModel() to set the Model."
+	);
+	TBTKAssert(
+		state.size() == (unsigned int)model->getBasisSize(),
+		"ChebyshevTimePropagator::step()",
+		"The size of the state '" << state.size() << "' does not"
+		<< " match the basis size '" << model->getBasisSize()
+		<< "'.",
+		"Use ChebyshevTimePropagator::setState() to set the state."
+	);
+
+	//Evaluate the Hamiltonian at the midpoint of the time step.
+	if(!hamiltonian || isTimeDependent){
+		hamiltonianTime = time + timeStep/2;
+		update();
+	}
+
+	//Sum the expansion using the recursion
+	//T_{k+1}(H)|v> = 2H T_k(H)|v> - T_{k-1}(H)|v>.
+	unsigned int basisSize = state.size();
+	previous = state;
+	current.resize(basisSize);
+	next.resize(basisSize);
+	result.resize(basisSize);
+	#pragma omp parallel for
+	for(unsigned int n = 0; n < basisSize; n++)
+		result[n] = coefficients[0]*previous[n];
+
+	if(coefficients.size() > 1){
+		hamiltonian->apply(
+			previous.data(),
+			current.data(),
+			1/halfWidth,
+			center
+		);
+		#pragma omp parallel for
+		for(unsigned int n = 0; n < basisSize; n++)
+			result[n] += coefficients[1]*current[n];
+	}
+
+	for(unsigned int k = 2; k < coefficients.size(); k++){
+		hamiltonian->apply(
+			current.data(),
+			next.data(),
+			2/halfWidth,
+			center
+		);
+		#pragma omp parallel for
+		for(unsigned int n = 0; n < basisSize; n++){
+			next[n] -= previous[n];
+			result[n] += coefficients[k]*next[n];
+		}
+
+		previous.swap(current);
+		current.swap(next);
+	}
+
+	state.swap(result);
+	time += timeStep;
+}
+
+void ChebyshevTimePropagator::update(){
+	//The sparsity pattern only has to be extracted once, after that it is
+	//enough to reevaluate the values.
+	if(hamiltonian)
+		hamiltonian->updateValues(*model);
+	else
+		hamiltonian.reset(new SparseHamiltonian(*model));
+
+	double lowerBound, upperBound;
+	hamiltonian->getSpectralBounds(lowerBound, upperBound);
+	center = (upperBound + lowerBound)/2.;
+	halfWidth = (upperBound - lowerBound)/(2. - SPECTRAL_MARGIN);
+	if(halfWidth == 0)
+		halfWidth = 1;
+
+	//The coefficients are (2 - delta_{k0})(-i)^k J_k(a*dt), multiplied
+	//by the phase exp(-i*E_c*dt) from the shift of the spectrum.
+	vector<double> besselFunctions
+		= calculateBesselFunctions(halfWidth*timeStep);
+	complex<double> phase = polar(1., -center*timeStep);
+	complex<double> power = 1;
+	coefficients.resize(besselFunctions.size());
+	for(unsigned int k = 0; k < besselFunctions.size(); k++){
+		coefficients[k] = (k == 0 ? 1. : 2.)*power*besselFunctions[k]
+			*phase;
+		power *= complex<double>(0, -1);
+	}
+}
+
+vector<double> ChebyshevTimePropagator::calculateBesselFunctions(double x){
+	if(x == 0)
+		return {1};
+
+	//The Bessel functions are negligible for orders well above x.
+	//Start the recurrence
+	//J_{k-1}(x) = (2k/x)J_k(x) - J_{k+1}(x) above that and normalize
+	//the result using J_0(x) + 2*sum_k J_{2k}(x) = 1.
+	unsigned int startOrder = x + 20 + 10*cbrt(x);
+	vector<double> besselFunctions(startOrder + 2, 0);
+	besselFunctions[startOrder] = 1e-300;
+	for(unsigned int k = startOrder; k > 0; k--){
+		besselFunctions[k-1] = 2*k/x*besselFunctions[k]
+			- besselFunctions[k+1];
+		if(abs(besselFunctions[k-1]) > RESCALE_THRESHOLD){
+			for(unsigned int c = k - 1; c <= startOrder; c++)
+				besselFunctions[c] /= RESCALE_THRESHOLD;
+		}
+	}
+
+	double normalization = besselFunctions[0];
+	for(unsigned int k = 2; k <= startOrder; k += 2)
+		normalization += 2*besselFunctions[k];
+	for(unsigned int k = 0; k <= startOrder; k++)
+		besselFunctions[k] /= normalization;
+
+	//Drop the negligible high order terms.
+	unsigned int numTerms = startOrder + 1;
+	while(numTerms > 1 && abs(besselFunctions[numTerms-1]) < TOLERANCE)
+		numTerms--;
+	besselFunctions.resize(numTerms);
+
+	return besselFunctions;
+}
@@ -13,6 +13,10 @@
  * limitations under the License.
  */
 
+#include "AsyncOutput.h"
+#include "ChebyshevTimePropagator.h"
+#include "InertiaPropertyExtractor.h"
+#include "InertiaSolver.h"
 #include "TBTK/Model.h"
 #include "TBTK/PropertyExtractor/Diagonalizer.h"
 #include "TBTK/Solver/Diagonalizer.h"
@@ -225,13 +229,11 @@ void shiftProbabilityDensities(
 
 //Plot the potential and probability densities and save the results to file.
 void plot(
+	const Array<double> &potential,
 	Array<double> probabilityDensities,
 	const Property::EigenValues &eigenValues,
 	const string &filename
 ){
-	//Get the current potential on array format.
-	Array<double> potential = getPotential();
-
 	//Set the minimum bound for the plot to be the minimum of the
 	//potential. Set the maximum bound to be the energy of the
 	//state that is one higher than the last state for which the
@@ -286,6 +288,201 @@ void plot(
 	plotter.save(filename);
 }
 
+//Plot the number of states below a given energy and save the result to file.
+void plotIntegratedDOS(
+	const Array<double> &integratedDOS,
+	double lowerBound,
+	double upperBound,
+	const string &filename
+){
+	Plotter plotter;
+	plotter.setLabelX("Energy");
+	plotter.setLabelY("Number of states");
+	unsigned int energyResolution = integratedDOS.getRanges()[0];
+	vector<double> energies;
+	vector<double> numStates;
+	for(unsigned int e = 0; e < energyResolution; e++){
+		energies.push_back(
+			lowerBound
+			+ e*(upperBound - lowerBound)/(energyResolution - 1)
+		);
+		numStates.push_back(integratedDOS[{e}]);
+	}
+	plotter.plot(energies, numStates, {{"color", "black"}});
+	plotter.save(filename);
+}
+
+///////////////////////////
+// Wave packet dynamics. //
+///////////////////////////
+//Initial position, width, and momentum of the wave packet, the total time to
+//propagate it, and the time between two observations of the probability
+//density.
+const double WAVE_PACKET_CENTER = 100;
+const double WAVE_PACKET_WIDTH = 20;
+const double WAVE_PACKET_MOMENTUM = 0.07;
+const double SIMULATION_TIME = 2500;
+const double OBSERVATION_INTERVAL = 50;
+
+//Time step for static potentials. The Chebyshev expansion is exact for any
+//time step, so it can be large.
+const double TIME_STEP = 10;
+
+//Time step for time dependent potentials. The Hamiltonian is held constant
+//over each time step, which gives an error of order dt^3 per step. The time
+//step therefore has to be small compared to the time over which the
+//potential changes.
+const double TIME_DEPENDENT_TIME_STEP = 1;
+
+//Barrier that is ramped up linearly from zero to its full height during
+//RAMP_TIME.
+complex<double> rampedBarrier(int x, double time){
+	//Parameters.
+	const double BARRIER_HEIGHT = 8e-3;
+	const double BARRIER_LEFT_BOUNDARY_SITE = 225;
+	const double BARRIER_RIGHT_BOUNDARY_SITE = 275;
+	const double RAMP_TIME = 2000;
+
+	if(x < BARRIER_LEFT_BOUNDARY_SITE || x >= BARRIER_RIGHT_BOUNDARY_SITE)
+		return 0;
+	else if(time < RAMP_TIME)
+		return BARRIER_HEIGHT*time/RAMP_TIME;
+	else
+		return BARRIER_HEIGHT;
+}
+
+//Callback that returns the ramped barrier at the time at which the
+//ChebyshevTimePropagator evaluates the Hamiltonian.
+class RampedBarrierCallback : public HoppingAmplitude::AmplitudeCallback{
+public:
+	RampedBarrierCallback(
+		const ChebyshevTimePropagator &propagator
+	) :
+		propagator(propagator)
+	{
+	}
+
+	complex<double> getHoppingAmplitude(
+		const Index &to,
+		const Index &from
+	) const{
+		return rampedBarrier(
+			from[0],
+			propagator.getHamiltonianTime()
+		);
+	}
+private:
+	const ChebyshevTimePropagator &propagator;
+};
+
+//Returns a normalized Gaussian wave packet that moves to the right.
+vector<complex<double>> createWavePacket(const Model &model){
+	vector<complex<double>> wavePacket(model.getBasisSize());
+	double normalization = 0;
+	for(unsigned int x = 0; x < (unsigned int)SIZE_X; x++){
+		complex<double> amplitude = exp(
+			-pow(x - WAVE_PACKET_CENTER, 2)
+			/(4*pow(WAVE_PACKET_WIDTH, 2))
+		)*polar(1., WAVE_PACKET_MOMENTUM*x);
+		wavePacket[model.getBasisIndex({x})] = amplitude;
+		normalization += norm(amplitude);
+	}
+	for(unsigned int n = 0; n < wavePacket.size(); n++)
+		wavePacket[n] /= sqrt(normalization);
+
+	return wavePacket;
+}
+
+//Plot the probability density of the wave packet as a function of time and
+//position and save the result to file.
+void plotWavePacket(
+	const Array<double> &probabilityDensities,
+	const string &filename
+){
+	Plotter plotter;
+	plotter.setLabelX("Time");
+	plotter.setLabelY("x");
+	plotter.plot(probabilityDensities);
+	plotter.save(filename);
+}
+
+//Propagate a wave packet using a ChebyshevTimePropagator that has been set up
+//with the given Model. The probability density is queued for output at fixed
+//time intervals.
+void simulateWavePacket(
+	const Model &model,
+	ChebyshevTimePropagator &propagator,
+	double timeStep,
+	const string &name,
+	AsyncOutput &output
+){
+	propagator.setTimeStep(timeStep);
+	propagator.setState(createWavePacket(model));
+
+	const unsigned int STEPS_PER_OBSERVATION
+		= round(OBSERVATION_INTERVAL/timeStep);
+	const unsigned int NUM_OBSERVATIONS
+		= round(SIMULATION_TIME/OBSERVATION_INTERVAL) + 1;
+	Array<double> probabilityDensities({NUM_OBSERVATIONS, SIZE_X});
+	for(
+		unsigned int observation = 0;
+		observation < NUM_OBSERVATIONS;
+		observation++
+	){
+		if(observation != 0)
+			for(unsigned int n = 0; n < STEPS_PER_OBSERVATION; n++)
+				propagator.step();
+
+		const vector<complex<double>> &state = propagator.getState();
+		Array<double> probabilityDensity({SIZE_X});
+		for(unsigned int x = 0; x < (unsigned int)SIZE_X; x++){
+			probabilityDensity[{x}] = norm(
+				state[model.getBasisIndex({x})]
+			);
+			probabilityDensities[{observation, x}]
+				= probabilityDensity[{x}];
+		}
+		output.write(
+			name + "/WavePacket/" + to_string(observation),
+			probabilityDensity
+		);
+	}
+
+	string filename = "figures/WavePacket_" + name + ".png";
+	output.plot([=](){
+		plotWavePacket(probabilityDensities, filename);
+	});
+}
+
+//Propagate a wave packet towards a barrier that is ramped up while the wave
+//packet moves.
+void simulateRampedBarrier(AsyncOutput &output){
+	ChebyshevTimePropagator propagator;
+	RampedBarrierCallback rampedBarrierCallback(propagator);
+
+	Model model;
+	for(unsigned int x = 0; x < SIZE_X; x++){
+		//Kinetic terms.
+		model << HoppingAmplitude(2*t, {x}, {x});
+		if(x + 1 < SIZE_X)
+			model << HoppingAmplitude(-t, {x + 1}, {x}) + HC;
+
+		//Time dependent potential term.
+		model << HoppingAmplitude(rampedBarrierCallback, {x}, {x});
+	}
+	model.construct();
+
+	propagator.setModel(model);
+	propagator.setTimeDependent(true);
+	simulateWavePacket(
+		model,
+		propagator,
+		TIME_DEPENDENT_TIME_STEP,
+		"RampedBarrier",
+		output
+	);
+}
+
 ///////////
 // Main. //
 ///////////
@@ -311,6 +508,10 @@ int main(int argc, char **argv){
 	solver.setModel(model);
 	PropertyExtractor::Diagonalizer propertyExtractor(solver);
 
+	//Setup the InertiaSolver.
+	InertiaSolver inertiaSolver;
+	inertiaSolver.setModel(model);
+
 	//List of potentials to run the calculation for.
 	vector<PotentialType> potentialTypes = {
 		InfiniteSquareWell,
@@ -322,17 +523,22 @@ int main(int argc, char **argv){
 		Barrier
 	};
 
-	//List of filenames to save the results to.
-	vector<string> filenames = {
-		"figures/InfiniteSquareWell.png",
-		"figures/SquareWell.png",
-		"figures/DoubleSquareWell.png",
-		"figures/HarmonicOscillator.png",
-		"figures/DoubleWell.png",
-		"figures/Step.png",
-		"figures/Barrier.png"
+	//Names of the potentials, used for the results and figures.
+	vector<string> names = {
+		"InfiniteSquareWell",
+		"SquareWell",
+		"DoubleSquareWell",
+		"HarmonicOscillator",
+		"DoubleWell",
+		"Step",
+		"Barrier"
 	};
 
+	//Write the results and render the figures on a background thread,
+	//so that the calculation for the next potential can start
+	//immediately.
+	AsyncOutput output("figures/Results.bin");
+
 	//Run the calculation and plot the result for each potential.
 	for(unsigned int n = 0; n < potentialTypes.size(); n++){
 		//Set the current potential.
@@ -359,13 +565,78 @@ int main(int argc, char **argv){
 		Property::EigenValues eigenValues
 			= propertyExtractor.getEigenValues();
 
-		//Plot the results.
-		plot(
-			probabilityDensities,
-			eigenValues,
-			filenames[n]
+		//Get the current potential on array format.
+		Array<double> potential = getPotential();
+
+		//Queue the results. The figure is rendered from copies of the
+		//results, since the potential changes in the next iteration.
+		output.write(names[n] + "/Potential", potential);
+		output.write(
+			names[n] + "/ProbabilityDensities",
+			probabilityDensities
 		);
+		string filename = "figures/" + names[n] + ".png";
+		output.plot([=](){
+			plot(
+				potential,
+				probabilityDensities,
+				eigenValues,
+				filename
+			);
+		});
+
+		//Count the states below each energy for the current potential
+		//in the same energy range as the plot. The InertiaSolver reads
+		//the HoppingAmplitudes when it is run and therefore has to be
+		//rerun for each potential.
+		const double LOWER_BOUND = getMin(potential);
+		const double UPPER_BOUND = eigenValues(NUM_STATES);
+		const int ENERGY_RESOLUTION = 1000;
+		inertiaSolver.run();
+		InertiaPropertyExtractor inertiaPropertyExtractor(inertiaSolver);
+		inertiaPropertyExtractor.setEnergyWindow(
+			LOWER_BOUND,
+			UPPER_BOUND,
+			ENERGY_RESOLUTION
+		);
+		Array<double> integratedDOS
+			= inertiaPropertyExtractor.calculateIntegratedDOS();
+
+		//Queue the integrated DOS.
+		output.write(names[n] + "/IntegratedDOS", integratedDOS);
+		string integratedDOSFilename
+			= "figures/IntegratedDOS_" + names[n] + ".png";
+		output.plot([=](){
+			plotIntegratedDOS(
+				integratedDOS,
+				LOWER_BOUND,
+				UPPER_BOUND,
+				integratedDOSFilename
+			);
+		});
+
+		//Simulate the scattering of a wave packet on the step and on
+		//the barrier.
+		if(potentialType == Step || potentialType == Barrier){
+			ChebyshevTimePropagator propagator;
+			propagator.setModel(model);
+			simulateWavePacket(
+				model,
+				propagator,
+				TIME_STEP,
+				names[n],
+				output
+			);
+		}
 	}
 
+	//Simulate the scattering of a wave packet on a barrier that changes
+	//in time.
+	simulateRampedBarrier(output);
+
+	//Wait for the remaining results to be written and the remaining
+	//figures to be rendered.
+	output.flush();
+
 	return 0;
 }
@@ -0,0 +1,106 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file BlockPropertyExtractor.h
+ *  @brief Extracts properties from a BlockSolver.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef BLOCK_PROPERTY_EXTRACTOR
+#define BLOCK_PROPERTY_EXTRACTOR
+
+#include "BlockSolver.h"
+#include "TBTK/Index.h"
+#include "TBTK/Property/DOS.h"
+
+#include <complex>
+
+class BlockPropertyExtractor{
+public:
+	/** Constructor.
+	 *
+	 *  @param solver The BlockSolver to extract properties from. */
+	BlockPropertyExtractor(const BlockSolver &solver);
+
+	/** Set the energy window used for energy dependent quantities.
+	 *
+	 *  @param lowerBound The lower bound of the energy window.
+	 *  @param upperBound The upper bound of the energy window.
+	 *  @param energyResolution The number of points used to resolve the
+	 *  energy window. */
+	void setEnergyWindow(
+		double lowerBound,
+		double upperBound,
+		int energyResolution
+	);
+
+	/** Calculate the density of states. Only requires the eigenvalues.
+	 *
+	 *  @return The density of states. */
+	TBTK::Property::DOS calculateDOS() const;
+
+	/** Get an eigenvalue within a given block.
+	 *
+	 *  @param blockIndex The Index of the block.
+	 *  @param state The state number within the block.
+	 *
+	 *  @return The eigenvalue. */
+	double getEigenValue(
+		const TBTK::Index &blockIndex,
+		unsigned int state
+	) const;
+
+	/** Get the amplitude of an eigenvector within a given block. Fails if
+	 *  the BlockSolver only has calculated the eigenvalues.
+	 *
+	 *  @param blockIndex The Index of the block.
+	 *  @param state The state number within the block.
+	 *  @param index The physical Index to get the amplitude for.
+	 *
+	 *  @return The amplitude \f$\Psi_{n}(i)\f$. */
+	std::complex<double> getAmplitude(
+		const TBTK::Index &blockIndex,
+		unsigned int state,
+		const TBTK::Index &index
+	) const;
+private:
+	/** The BlockSolver to extract properties from. */
+	const BlockSolver &solver;
+
+	/** The energy window. */
+	double lowerBound;
+	double upperBound;
+	int energyResolution;
+};
+
+inline void BlockPropertyExtractor::setEnergyWindow(
+	double lowerBound,
+	double upperBound,
+	int energyResolution
+){
+	this->lowerBound = lowerBound;
+	this->upperBound = upperBound;
+	this->energyResolution = energyResolution;
+}
+
+inline double BlockPropertyExtractor::getEigenValue(
+	const TBTK::Index &blockIndex,
+	unsigned int state
+) const{
+	return solver.getEigenValue(blockIndex, state);
+}
+
+#endif
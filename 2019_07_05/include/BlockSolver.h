@@ -0,0 +1,300 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file BlockSolver.h
+ *  @brief Diagonalizes the blocks of a block diagonal Model.
+ *
+ *  In contrast to Solver::BlockDiagonalizer, the BlockSolver can be set up to
+ *  only calculate the eigenvalues. No memory is then allocated for the
+ *  eigenvectors, which otherwise dominates the memory footprint for Models
+ *  with large blocks.
+ *
+ *  The Model is required to be Hermitian, that is, to contain the Hermitian
+ *  conjugate of every HoppingAmplitude. Only the HoppingAmplitudes in the upper
+ *  triangle of each block are read when the blocks are set up, since the
+ *  lower triangle is not used by the diagonalization.
+ *
+ *  BlockAccumulators can also be added to the BlockSolver, in which case each
+ *  block is passed on to the accumulators directly after it has been solved.
+ *  If the results are not stored, the memory required by the BlockSolver is
+ *  then independent of the number of blocks.
+ *
+ *  The results can also be stored out of core in a BlockStore. The BlockSolver
+ *  then resumes from the last checkpoint in the BlockStore, and the stored
+ *  blocks are paged in when they are accessed. The accessors for the
+ *  eigenvalues and eigenvectors can be called from several threads at once,
+ *  since the paging is serialized by a mutex. If a ResultCache is set, the
+ *  results are stored in the cache entry for the Hamiltonian, and a Model
+ *  that has been solved before is read back from the cache instead of being
+ *  solved again.
+ *
+ *  The blocks can be diagonalized in single precision, which halves the
+ *  memory bandwidth and doubles the SIMD width of the diagonalization. In
+ *  mixed precision, the eigenvalues are in addition refined to double
+ *  precision using the Rayleigh quotient of the single precision
+ *  eigenvectors. The results are always stored in double precision.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef BLOCK_SOLVER
+#define BLOCK_SOLVER
+
+#include "BlockAccumulator.h"
+#include "BlockStore.h"
+#include "ResultCache.h"
+#include "TBTK/Index.h"
+#include "TBTK/Model.h"
+
+#include <complex>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class BlockSolver{
+public:
+	/** Enum class for specifying what to calculate. */
+	enum class Mode{EigenValues, EigenValuesAndEigenVectors};
+
+	/** Enum class for specifying the precision of the diagonalization.
+	 *  Single gives eigenvalues and eigenvectors with single precision
+	 *  accuracy. Mixed gives eigenvalues with close to double precision
+	 *  accuracy, but the eigenvectors are only accurate to single
+	 *  precision. */
+	enum class Precision{Double, Single, Mixed};
+
+	/** Constructor. */
+	BlockSolver();
+
+	/** Set the Model to solve.
+	 *
+	 *  @param model The Model to solve. */
+	void setModel(const TBTK::Model &model);
+
+	/** Set the mode. Defaults to Mode::EigenValuesAndEigenVectors.
+	 *
+	 *  @param mode The mode to use. */
+	void setMode(Mode mode);
+
+	/** Get the mode.
+	 *
+	 *  @return The mode. */
+	Mode getMode() const;
+
+	/** Set the precision. Defaults to Precision::Double.
+	 *
+	 *  @param precision The precision to use. */
+	void setPrecision(Precision precision);
+
+	/** Get the precision.
+	 *
+	 *  @return The precision. */
+	Precision getPrecision() const;
+
+	/** Set whether the eigenvalues and eigenvectors are stored. Defaults
+	 *  to true. Set to false to only pass the results on to the
+	 *  accumulators.
+	 *
+	 *  @param storeResults Flag indicating whether to store the results.
+	 */
+	void setStoreResults(bool storeResults);
+
+	/** Get whether the eigenvalues and eigenvectors are stored.
+	 *
+	 *  @return True if the results are stored. */
+	bool getStoreResults() const;
+
+	/** Add a BlockAccumulator that each block is passed on to once it has
+	 *  been diagonalized. The BlockAccumulator is not owned by the
+	 *  BlockSolver and must stay alive until run() has returned.
+	 *
+	 *  @param accumulator The BlockAccumulator to add. */
+	void addAccumulator(BlockAccumulator &accumulator);
+
+	/** Store the results out of core in a BlockStore instead of in
+	 *  memory. Only used if the results are stored. The BlockStore is not
+	 *  owned by the BlockSolver and must stay alive as long as the results
+	 *  are accessed.
+	 *
+	 *  @param blockStore The BlockStore to store the results in. */
+	void setBlockStore(BlockStore &blockStore);
+
+	/** Set a ResultCache to read previously calculated results from and
+	 *  to store new results in. Used unless the results are stored in a
+	 *  BlockStore set with setBlockStore(). The ResultCache is not owned
+	 *  by the BlockSolver and must stay alive until run() has returned.
+	 *
+	 *  @param cache The ResultCache to use. */
+	void setCache(ResultCache &cache);
+
+	/** Diagonalize all blocks. */
+	void run();
+
+	/** Get the basis size.
+	 *
+	 *  @return The basis size of the Model. */
+	unsigned int getBasisSize() const;
+
+	/** Get an eigenvalue using a global state index.
+	 *
+	 *  @param state The state to get the eigenvalue for.
+	 *
+	 *  @return The eigenvalue. */
+	double getEigenValue(unsigned int state) const;
+
+	/** Get an eigenvalue within a given block.
+	 *
+	 *  @param blockIndex The Index of the block.
+	 *  @param state The state number within the block.
+	 *
+	 *  @return The eigenvalue. */
+	double getEigenValue(
+		const TBTK::Index &blockIndex,
+		unsigned int state
+	) const;
+
+	/** Get the amplitude of an eigenvector within a given block. Only
+	 *  available in Mode::EigenValuesAndEigenVectors.
+	 *
+	 *  @param blockIndex The Index of the block.
+	 *  @param state The state number within the block.
+	 *  @param index The physical Index to get the amplitude for.
+	 *
+	 *  @return The amplitude \f$\Psi_{n}(i)\f$. */
+	std::complex<double> getAmplitude(
+		const TBTK::Index &blockIndex,
+		unsigned int state,
+		const TBTK::Index &index
+	) const;
+private:
+	/** The Model to solve. */
+	const TBTK::Model *model;
+
+	/** The mode. */
+	Mode mode;
+
+	/** The precision. */
+	Precision precision;
+
+	/** Flag indicating whether to store the results. */
+	bool storeResults;
+
+	/** BlockStore for storing the results out of core. */
+	BlockStore *blockStore;
+
+	/** ResultCache for previously calculated results. */
+	ResultCache *cache;
+
+	/** BlockStore for the entry in the ResultCache that is in use. */
+	std::unique_ptr<BlockStore> cacheStore;
+
+	/** Mutex that serializes the accesses to the BlockStore from the
+	 *  const accessors, since BlockStore::getChunk() is not thread safe.
+	 */
+	mutable std::mutex storeMutex;
+
+	/** Accumulators to pass the solved blocks on to. */
+	std::vector<BlockAccumulator*> accumulators;
+
+	/** The first basis index in each block, followed by the basis size.
+	 */
+	std::vector<unsigned int> blockOffsets;
+
+	/** Offsets into the eigenvector storage for each block. */
+	std::vector<unsigned long> eigenVectorOffsets;
+
+	/** Eigenvalues ordered by block and sorted within each block. */
+	std::vector<double> eigenValues;
+
+	/** Eigenvectors. The amplitude for state n at intra block basis index
+	 *  i in a block of size N is stored at eigenVectorOffsets[block] +
+	 *  N*n + i. */
+	std::vector<std::complex<double>> eigenVectors;
+
+	/** Get the BlockStore that the results are stored in. Returns
+	 *  nullptr if the results are stored in memory or not at all. */
+	BlockStore* getBlockStore() const;
+
+	/** Calculate a key that identifies the results from the Hamiltonian
+	 *  and the parts of the configuration that affect what is stored. */
+	unsigned long calculateKey() const;
+
+	/** Get the block number for the block that contains the given basis
+	 *  index. */
+	unsigned int getBlock(unsigned int basisIndex) const;
+
+	/** Diagonalize a single block using the current precision. The
+	 *  Hamiltonian is passed on column major format and is overwritten by
+	 *  the eigenvectors if they are calculated. */
+	void solveBlock(
+		unsigned int block,
+		std::complex<double> *hamiltonian,
+		double *eigenValues,
+		bool calculateEigenVectors
+	) const;
+};
+
+inline void BlockSolver::setModel(const TBTK::Model &model){
+	this->model = &model;
+}
+
+inline void BlockSolver::setMode(Mode mode){
+	this->mode = mode;
+}
+
+inline BlockSolver::Mode BlockSolver::getMode() const{
+	return mode;
+}
+
+inline void BlockSolver::setPrecision(Precision precision){
+	this->precision = precision;
+}
+
+inline BlockSolver::Precision BlockSolver::getPrecision() const{
+	return precision;
+}
+
+inline void BlockSolver::setStoreResults(bool storeResults){
+	this->storeResults = storeResults;
+}
+
+inline bool BlockSolver::getStoreResults() const{
+	return storeResults;
+}
+
+inline void BlockSolver::setBlockStore(BlockStore &blockStore){
+	this->blockStore = &blockStore;
+}
+
+inline void BlockSolver::setCache(ResultCache &cache){
+	this->cache = &cache;
+}
+
+inline void BlockSolver::addAccumulator(BlockAccumulator &accumulator){
+	accumulators.push_back(&accumulator);
+}
+
+inline BlockStore* BlockSolver::getBlockStore() const{
+	if(cacheStore)
+		return cacheStore.get();
+
+	return storeResults ? blockStore : nullptr;
+}
+
+inline unsigned int BlockSolver::getBasisSize() const{
+	return blockOffsets.empty() ? 0 : blockOffsets.back();
+}
+
+#endif
@@ -0,0 +1,167 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file BlockStore.h
+ *  @brief Out-of-core storage for the solved blocks of a BlockSolver.
+ *
+ *  The BlockStore writes the results of a BlockSolver to a directory, one
+ *  chunk of consecutive blocks per file. A checkpoint file that records the
+ *  number of completed chunks is atomically replaced after each chunk has been
+ *  written, which allows an interrupted calculation to be resumed from the
+ *  last completed chunk. Each chunk is stored together with a checksum that
+ *  is verified when it is read. The stored chunks are read back lazily and
+ *  the most recently used chunks are kept in an LRU cache.
+ *
+ *  The BlockStore is not thread safe.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef BLOCK_STORE
+#define BLOCK_STORE
+
+#include <complex>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class BlockStore{
+public:
+	/** The eigenvalues and eigenvectors of a chunk of blocks. */
+	class Chunk{
+	public:
+		/** Eigenvalues of the chunk. */
+		std::vector<double> eigenValues;
+
+		/** Eigenvectors of the chunk. Empty if the eigenvectors are
+		 *  not stored. */
+		std::vector<std::complex<double>> eigenVectors;
+	};
+
+	/** Constructor.
+	 *
+	 *  @param directory The directory to store the chunks in. Created if
+	 *  it does not exist.
+	 *  @param cacheSize The maximum number of chunks to keep in memory. */
+	BlockStore(const std::string &directory, unsigned int cacheSize = 16);
+
+	/** Open the store for a calculation. If the checkpoint in the
+	 *  directory belongs to a calculation with the same parameters and
+	 *  key, the calculation is resumed after the last chunk recorded in
+	 *  the checkpoint. Otherwise the store is reset. Only the checkpoint is
+	 *  read. The checksum of each chunk is verified when getChunk() loads
+	 *  it.
+	 *
+	 *  @param numChunks The total number of chunks.
+	 *  @param basisSize The basis size of the Model.
+	 *  @param hasEigenVectors Whether the eigenvectors are stored.
+	 *  @param key Key that identifies the calculation, such as the one
+	 *  returned by ResultCache::calculateKey().
+	 *
+	 *  @return The number of chunks that already are stored. */
+	unsigned int open(
+		unsigned int numChunks,
+		unsigned int basisSize,
+		bool hasEigenVectors,
+		unsigned long key
+	);
+
+	/** Write the next chunk and update the checkpoint.
+	 *
+	 *  @param chunk The chunk number. Must be equal to the number of
+	 *  already stored chunks.
+	 *  @param eigenValues Pointer to the eigenvalues of the chunk.
+	 *  @param numEigenValues The number of eigenvalues.
+	 *  @param eigenVectors Pointer to the eigenvectors of the chunk.
+	 *  Ignored if the eigenvectors are not stored.
+	 *  @param numEigenVectorEntries The number of eigenvector entries. */
+	void writeChunk(
+		unsigned int chunk,
+		const double *eigenValues,
+		unsigned int numEigenValues,
+		const std::complex<double> *eigenVectors,
+		unsigned long numEigenVectorEntries
+	);
+
+	/** Get a chunk. The chunk is read from file if it is not in the cache.
+	 *  The returned reference is valid until the next call to getChunk().
+	 *
+	 *  @param chunk The chunk number.
+	 *
+	 *  @return The chunk. */
+	const Chunk& getChunk(unsigned int chunk);
+
+	/** Get the number of completed chunks.
+	 *
+	 *  @return The number of chunks that are stored. */
+	unsigned int getNumStoredChunks() const;
+
+	/** Get whether the eigenvectors are stored.
+	 *
+	 *  @return True if the eigenvectors are stored. */
+	bool getHasEigenVectors() const;
+private:
+	/** The checkpoint. */
+	class Checkpoint{
+	public:
+		unsigned int magic;
+		unsigned int numChunks;
+		unsigned int basisSize;
+		unsigned int hasEigenVectors;
+		unsigned int numStoredChunks;
+		unsigned long key;
+	};
+
+	/** The directory to store the chunks in. */
+	std::string directory;
+
+	/** The maximum number of chunks to keep in memory. */
+	unsigned int cacheSize;
+
+	/** The current checkpoint. */
+	Checkpoint checkpoint;
+
+	/** Chunk numbers ordered from most to least recently used. */
+	std::list<unsigned int> recentlyUsed;
+
+	/** Cached chunks together with their position in recentlyUsed. */
+	std::unordered_map<
+		unsigned int,
+		std::pair<Chunk, std::list<unsigned int>::iterator>
+	> cache;
+
+	/** Read a chunk from file. Returns false if the file is missing or
+	 *  corrupt. */
+	bool readChunk(unsigned int chunk, Chunk &result) const;
+
+	/** Get the filename of a chunk. */
+	std::string getChunkFilename(unsigned int chunk) const;
+
+	/** Atomically replace the checkpoint file with the current
+	 *  checkpoint. */
+	void writeCheckpoint() const;
+};
+
+inline unsigned int BlockStore::getNumStoredChunks() const{
+	return checkpoint.numStoredChunks;
+}
+
+inline bool BlockStore::getHasEigenVectors() const{
+	return checkpoint.hasEigenVectors;
+}
+
+#endif
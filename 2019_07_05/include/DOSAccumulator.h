@@ -0,0 +1,86 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file DOSAccumulator.h
+ *  @brief Accumulates the density of states block by block.
+ *
+ *  The eigenvalues are counted as integers, which makes the result
+ *  independent of the order in which the blocks are accumulated.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef DOS_ACCUMULATOR
+#define DOS_ACCUMULATOR
+
+#include "BlockAccumulator.h"
+#include "TBTK/Property/DOS.h"
+
+#include <vector>
+
+class DOSAccumulator : public BlockAccumulator{
+public:
+	/** Constructor.
+	 *
+	 *  @param lowerBound The lower bound of the energy window.
+	 *  @param upperBound The upper bound of the energy window.
+	 *  @param energyResolution The number of points used to resolve the
+	 *  energy window. */
+	DOSAccumulator(
+		double lowerBound,
+		double upperBound,
+		int energyResolution
+	);
+
+	/** Implements BlockAccumulator::createEmpty(). */
+	virtual DOSAccumulator* createEmpty() const;
+
+	/** Implements BlockAccumulator::requiresEigenVectors(). */
+	virtual bool requiresEigenVectors() const;
+
+	/** Implements BlockAccumulator::accumulate(). */
+	virtual void accumulate(
+		unsigned int blockSize,
+		const double *eigenValues,
+		const std::complex<double> *eigenVectors
+	);
+
+	/** Implements BlockAccumulator::merge(). */
+	virtual void merge(const BlockAccumulator &blockAccumulator);
+
+	/** Get the accumulated density of states.
+	 *
+	 *  @return The density of states. */
+	TBTK::Property::DOS getDOS() const;
+private:
+	/** The energy window. */
+	double lowerBound;
+	double upperBound;
+	int energyResolution;
+
+	/** The number of eigenvalues in each energy bin. */
+	std::vector<unsigned long> counts;
+};
+
+inline DOSAccumulator* DOSAccumulator::createEmpty() const{
+	return new DOSAccumulator(lowerBound, upperBound, energyResolution);
+}
+
+inline bool DOSAccumulator::requiresEigenVectors() const{
+	return false;
+}
+
+#endif
@@ -0,0 +1,80 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file OccupationAccumulator.h
+ *  @brief Accumulates the total occupation block by block.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef OCCUPATION_ACCUMULATOR
+#define OCCUPATION_ACCUMULATOR
+
+#include "BlockAccumulator.h"
+
+class OccupationAccumulator : public BlockAccumulator{
+public:
+	/** Constructor.
+	 *
+	 *  @param chemicalPotential The chemical potential.
+	 *  @param kT The temperature in units of energy. A zero temperature
+	 *  results in a step function occupation. */
+	OccupationAccumulator(double chemicalPotential, double kT);
+
+	/** Implements BlockAccumulator::createEmpty(). */
+	virtual OccupationAccumulator* createEmpty() const;
+
+	/** Implements BlockAccumulator::requiresEigenVectors(). */
+	virtual bool requiresEigenVectors() const;
+
+	/** Implements BlockAccumulator::accumulate(). */
+	virtual void accumulate(
+		unsigned int blockSize,
+		const double *eigenValues,
+		const std::complex<double> *eigenVectors
+	);
+
+	/** Implements BlockAccumulator::merge(). */
+	virtual void merge(const BlockAccumulator &blockAccumulator);
+
+	/** Get the accumulated occupation.
+	 *
+	 *  @return The sum of the Fermi-Dirac occupation of all states. */
+	double getOccupation() const;
+private:
+	/** The chemical potential. */
+	double chemicalPotential;
+
+	/** The temperature in units of energy. */
+	double kT;
+
+	/** The accumulated occupation. */
+	double occupation;
+};
+
+inline OccupationAccumulator* OccupationAccumulator::createEmpty() const{
+	return new OccupationAccumulator(chemicalPotential, kT);
+}
+
+inline bool OccupationAccumulator::requiresEigenVectors() const{
+	return false;
+}
+
+inline double OccupationAccumulator::getOccupation() const{
+	return occupation;
+}
+
+#endif
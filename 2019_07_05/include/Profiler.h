@@ -0,0 +1,102 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file Profiler.h
+ *  @brief Records the time and resources spent in different phases of a
+ *  calculation.
+ *
+ *  Profiling is enabled by setting the environment variable PROFILER_OUTPUT
+ *  to the name of the file to write the results to. A phase is recorded by
+ *  creating a Profiler::Scope, which records the wall time, the CPU time, and
+ *  the number of allocations from its construction until it is destroyed or
+ *  stopped. The peak resident set size of the process up to the end of the
+ *  phase is also recorded. It is a lifetime peak for the whole process and
+ *  not the peak of the phase itself. When profiling is disabled,
+ *  a Scope only costs a check of a flag. Allocations are counted per thread,
+ *  so a phase only includes the allocations made by the thread that recorded
+ *  it, even if other threads run concurrently.
+ *
+ *  The results are written on the Chrome trace event format and can be
+ *  viewed in chrome://tracing. Each phase appears on the timeline of the
+ *  OpenMP thread that it was recorded on, and the file also contains a
+ *  summary of the total time spent in each phase and the total number of
+ *  allocations made by all threads.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef PROFILER
+#define PROFILER
+
+#include <string>
+
+class Profiler{
+public:
+	/** Records a phase from construction until destruction or until
+	 *  stop() is called. */
+	class Scope{
+	public:
+		/** Constructor.
+		 *
+		 *  @param name The name of the phase. Must be a string that
+		 *  outlives the Profiler, such as a string literal. */
+		Scope(const char *name);
+
+		/** Destructor. */
+		~Scope();
+
+		/** Stop recording the phase before the Scope is destroyed.
+		 */
+		void stop();
+	private:
+		/** The name of the phase. Null if the phase is not recorded.
+		 */
+		const char *name;
+
+		/** Wall time, CPU times, and allocation count at the start of
+		 *  the phase. */
+		double wallTime;
+		double cpuTime;
+		double threadCPUTime;
+		unsigned long numAllocations;
+	};
+
+	/** Get whether profiling is enabled.
+	 *
+	 *  @return True if profiling is enabled. */
+	static bool isEnabled();
+
+	/** Get the name of the file specified by PROFILER_OUTPUT.
+	 *
+	 *  @return The filename. */
+	static std::string getFilename();
+
+	/** Write the recorded phases to file.
+	 *
+	 *  @param filename The file to write the results to. */
+	static void write(const std::string &filename);
+
+	/** Count an allocation. Called by the global operator new. */
+	static void countAllocation();
+private:
+	/** Flag indicating whether profiling is enabled. */
+	static bool enabled;
+};
+
+inline bool Profiler::isEnabled(){
+	return enabled;
+}
+
+#endif
@@ -0,0 +1,100 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file SpectralFunctionAccumulator.h
+ *  @brief Accumulates the orbital resolved spectral function block by block.
+ *
+ *  The spectral function \f$A_{i}(E) = \sum_{\mathbf{k}n}|\Psi_{\mathbf{k}n}(i)|^2\delta(E - E_{\mathbf{k}n})\f$
+ *  is accumulated on an energy grid for each intra block index i. All blocks
+ *  are assumed to have the same orbital structure.
+ *
+ *  @author Kristofer Björnson
+ */
+
+#ifndef SPECTRAL_FUNCTION_ACCUMULATOR
+#define SPECTRAL_FUNCTION_ACCUMULATOR
+
+#include "BlockAccumulator.h"
+#include "TBTK/Array.h"
+
+#include <vector>
+
+class SpectralFunctionAccumulator : public BlockAccumulator{
+public:
+	/** Constructor.
+	 *
+	 *  @param numOrbitals The number of states in each block.
+	 *  @param lowerBound The lower bound of the energy window.
+	 *  @param upperBound The upper bound of the energy window.
+	 *  @param energyResolution The number of points used to resolve the
+	 *  energy window. */
+	SpectralFunctionAccumulator(
+		unsigned int numOrbitals,
+		double lowerBound,
+		double upperBound,
+		int energyResolution
+	);
+
+	/** Implements BlockAccumulator::createEmpty(). */
+	virtual SpectralFunctionAccumulator* createEmpty() const;
+
+	/** Implements BlockAccumulator::requiresEigenVectors(). */
+	virtual bool requiresEigenVectors() const;
+
+	/** Implements BlockAccumulator::accumulate(). */
+	virtual void accumulate(
+		unsigned int blockSize,
+		const double *eigenValues,
+		const std::complex<double> *eigenVectors
+	);
+
+	/** Implements BlockAccumulator::merge(). */
+	virtual void merge(const BlockAccumulator &blockAccumulator);
+
+	/** Get the accumulated spectral function.
+	 *
+	 *  @return The spectral function with ranges {numOrbitals,
+	 *  energyResolution}. */
+	TBTK::Array<double> getSpectralFunction() const;
+private:
+	/** The number of states in each block. */
+	unsigned int numOrbitals;
+
+	/** The energy window. */
+	double lowerBound;
+	double upperBound;
+	int energyResolution;
+
+	/** The accumulated spectral weight, stored as
+	 *  spectralWeights[energyResolution*orbital + e]. */
+	std::vector<double> spectralWeights;
+};
+
+inline SpectralFunctionAccumulator*
+SpectralFunctionAccumulator::createEmpty() const{
+	return new SpectralFunctionAccumulator(
+		numOrbitals,
+		lowerBound,
+		upperBound,
+		energyResolution
+	);
+}
+
+inline bool SpectralFunctionAccumulator::requiresEigenVectors() const{
+	return true;
+}
+
+#endif
@@ -0,0 +1,633 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file BlockSolver.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "BlockSolver.h"
+#include "Profiler.h"
+#include "TBTK/HoppingAmplitudeSet.h"
+#include "TBTK/IndexTree.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace TBTK;
+
+//Number of blocks to collect before they are diagonalized in parallel.
+static const unsigned int BLOCKS_PER_BATCH = 1024;
+
+//Number of consecutive blocks that are accumulated by the same thread.
+static const unsigned int BLOCKS_PER_CHUNK = 16;
+
+//LAPACK routine for diagonalizing a Hermitian matrix.
+extern "C" void zheev_(
+	const char *jobz,
+	const char *uplo,
+	const int *n,
+	complex<double> *a,
+	const int *lda,
+	double *w,
+	complex<double> *work,
+	const int *lwork,
+	double *rwork,
+	int *info
+);
+
+//LAPACK routine for diagonalizing a Hermitian matrix in single precision.
+extern "C" void cheev_(
+	const char *jobz,
+	const char *uplo,
+	const int *n,
+	complex<float> *a,
+	const int *lda,
+	float *w,
+	complex<float> *work,
+	const int *lwork,
+	float *rwork,
+	int *info
+);
+
+//BLAS routine for multiplying a Hermitian matrix with a general matrix.
+extern "C" void zhemm_(
+	const char *side,
+	const char *uplo,
+	const int *m,
+	const int *n,
+	const complex<double> *alpha,
+	const complex<double> *a,
+	const int *lda,
+	const complex<double> *b,
+	const int *ldb,
+	const complex<double> *beta,
+	complex<double> *c,
+	const int *ldc
+);
+
+BlockSolver::BlockSolver(){
+	model = nullptr;
+	mode = Mode::EigenValuesAndEigenVectors;
+	precision = Precision::Double;
+	storeResults = true;
+	blockStore = nullptr;
+	cache = nullptr;
+}
+
+void BlockSolver::run(){
+	TBTKAssert(
+		model != nullptr,
+		"BlockSolver::run()",
+		"Model not set.",
+		"Use BlockSolver::setModel() to set the Model."
+	);
+	Profiler::Scope scope("BlockSolver::run");
+	const HoppingAmplitudeSet &hoppingAmplitudeSet
+		= model->getHoppingAmplitudeSet();
+
+	//Calculate the offsets of the blocks and of their eigenvectors.
+	IndexTree blockIndices = hoppingAmplitudeSet.getSubspaceIndices();
+	blockOffsets.clear();
+	for(
+		IndexTree::ConstIterator iterator = blockIndices.cbegin();
+		iterator != blockIndices.cend();
+		++iterator
+	){
+		blockOffsets.push_back(
+			hoppingAmplitudeSet.getFirstIndexInBlock(*iterator)
+		);
+	}
+	blockOffsets.push_back(hoppingAmplitudeSet.getBasisSize());
+	unsigned int numBlocks = blockOffsets.size() - 1;
+
+	eigenVectorOffsets.assign(numBlocks + 1, 0);
+	for(unsigned int block = 0; block < numBlocks; block++){
+		unsigned long blockSize
+			= blockOffsets[block+1] - blockOffsets[block];
+		eigenVectorOffsets[block+1] = eigenVectorOffsets[block]
+			+ blockSize*blockSize;
+	}
+
+	//The eigenvectors are calculated if they are to be stored or if any
+	//of the accumulators need them.
+	bool calculateEigenVectors = mode == Mode::EigenValuesAndEigenVectors;
+	for(unsigned int n = 0; n < accumulators.size(); n++)
+		if(accumulators[n]->requiresEigenVectors())
+			calculateEigenVectors = true;
+
+	//Key that identifies the results in the ResultCache and in the
+	//checkpoint of the BlockStore. A BlockStore that contains the results
+	//for a different Hamiltonian or configuration is reset.
+	unsigned long key = 0;
+	if(cache != nullptr || blockStore != nullptr)
+		key = calculateKey();
+
+	//Use an entry in the ResultCache as BlockStore unless the results are
+	//stored in a BlockStore that has been set explicitly.
+	cacheStore.reset();
+	if(cache != nullptr && (blockStore == nullptr || !storeResults))
+		cacheStore.reset(new BlockStore(cache->getEntry(key)));
+	BlockStore *store = getBlockStore();
+
+	//Open the BlockStore if the results are stored out of core. Batches
+	//that already have been stored by an earlier run are not solved
+	//again.
+	unsigned int numStoredBatches = 0;
+	if(store != nullptr){
+		numStoredBatches = store->open(
+			(numBlocks + BLOCKS_PER_BATCH - 1)/BLOCKS_PER_BATCH,
+			hoppingAmplitudeSet.getBasisSize(),
+			mode == Mode::EigenValuesAndEigenVectors,
+			key
+		);
+	}
+
+	//Allocate storage. Nothing is stored in memory if the results are
+	//stored out of core or only are passed on to the accumulators, and
+	//the eigenvectors are only stored if requested.
+	eigenValues.clear();
+	eigenValues.shrink_to_fit();
+	eigenVectors.clear();
+	eigenVectors.shrink_to_fit();
+	if(storeResults && store == nullptr){
+		eigenValues.resize(hoppingAmplitudeSet.getBasisSize());
+		if(mode == Mode::EigenValuesAndEigenVectors)
+			eigenVectors.resize(eigenVectorOffsets[numBlocks]);
+	}
+
+	//Collect the blocks in batches and diagonalize each batch in
+	//parallel. Only the Hamiltonians and eigenvalues of the current batch
+	//are kept in memory.
+	HoppingAmplitudeSet::ConstIterator iterator
+		= hoppingAmplitudeSet.cbegin();
+	vector<complex<double>> hamiltonians;
+	vector<double> batchEigenValues;
+	for(
+		unsigned int firstBlock = 0;
+		firstBlock < numBlocks;
+		firstBlock += BLOCKS_PER_BATCH
+	){
+		unsigned int lastBlock = min(
+			firstBlock + BLOCKS_PER_BATCH,
+			numBlocks
+		);
+		unsigned int batch = firstBlock/BLOCKS_PER_BATCH;
+		unsigned long batchOffset = eigenVectorOffsets[firstBlock];
+
+		//Batches that already are stored only need to be processed if
+		//there are accumulators. They are then read back from the
+		//BlockStore, unless the accumulators need eigenvectors that
+		//have not been stored.
+		bool isStored = batch < numStoredBatches;
+		bool solveBatch = !isStored || (
+			!accumulators.empty()
+			&& calculateEigenVectors
+			&& !store->getHasEigenVectors()
+		);
+		bool loadBatch = isStored && !accumulators.empty()
+			&& !solveBatch;
+
+		hamiltonians.assign(
+			eigenVectorOffsets[lastBlock] - batchOffset,
+			0
+		);
+		batchEigenValues.resize(
+			blockOffsets[lastBlock] - blockOffsets[firstBlock]
+		);
+
+		//Write the HoppingAmplitudes of the batch to the
+		//Hamiltonians. The HoppingAmplitudes are ordered by block, so
+		//the iteration can be stopped at the first HoppingAmplitude
+		//that belongs to the next batch. Only the upper triangle is
+		//written since the lower triangle is not read by zheev.
+		Profiler::Scope fillScope("BlockSolver::fillHamiltonians");
+		unsigned int block = firstBlock;
+		for(; iterator != hoppingAmplitudeSet.cend(); ++iterator){
+			unsigned int row = hoppingAmplitudeSet.getBasisIndex(
+				(*iterator).getToIndex()
+			);
+			if(row >= blockOffsets[lastBlock])
+				break;
+			if(!solveBatch)
+				continue;
+			unsigned int column = hoppingAmplitudeSet.getBasisIndex(
+				(*iterator).getFromIndex()
+			);
+			if(row > column)
+				continue;
+
+			while(row >= blockOffsets[block+1])
+				block++;
+			unsigned int blockSize
+				= blockOffsets[block+1] - blockOffsets[block];
+
+			hamiltonians[
+				eigenVectorOffsets[block] - batchOffset
+				+ (row - blockOffsets[block])
+				+ (column - blockOffsets[block])*blockSize
+			] += (*iterator).getAmplitude();
+		}
+		fillScope.stop();
+
+		if(loadBatch){
+			Profiler::Scope loadScope("BlockSolver::loadBatch");
+			const BlockStore::Chunk &chunk
+				= store->getChunk(batch);
+			copy(
+				chunk.eigenValues.begin(),
+				chunk.eigenValues.end(),
+				batchEigenValues.begin()
+			);
+			if(calculateEigenVectors){
+				copy(
+					chunk.eigenVectors.begin(),
+					chunk.eigenVectors.end(),
+					hamiltonians.begin()
+				);
+			}
+		}
+		if(!solveBatch && !loadBatch)
+			continue;
+
+		//Diagonalize the blocks and accumulate their contributions
+		//chunk by chunk. The division into chunks does not depend on
+		//the number of threads and the chunks are merged in order, so
+		//the result is deterministic.
+		vector<vector<BlockAccumulator*>> chunkAccumulators(
+			(lastBlock - firstBlock + BLOCKS_PER_CHUNK - 1)
+			/BLOCKS_PER_CHUNK
+		);
+		#pragma omp parallel for schedule(dynamic)
+		for(
+			unsigned int chunk = 0;
+			chunk < chunkAccumulators.size();
+			chunk++
+		){
+			Profiler::Scope chunkScope("BlockSolver::solveChunk");
+			for(unsigned int n = 0; n < accumulators.size(); n++){
+				chunkAccumulators[chunk].push_back(
+					accumulators[n]->createEmpty()
+				);
+			}
+
+			unsigned int firstBlockInChunk
+				= firstBlock + chunk*BLOCKS_PER_CHUNK;
+			unsigned int lastBlockInChunk = min(
+				firstBlockInChunk + BLOCKS_PER_CHUNK,
+				lastBlock
+			);
+			for(
+				unsigned int block = firstBlockInChunk;
+				block < lastBlockInChunk;
+				block++
+			){
+				complex<double> *hamiltonian = &hamiltonians[
+					eigenVectorOffsets[block] - batchOffset
+				];
+				double *blockEigenValues = &batchEigenValues[
+					blockOffsets[block]
+					- blockOffsets[firstBlock]
+				];
+				if(solveBatch){
+					solveBlock(
+						block,
+						hamiltonian,
+						blockEigenValues,
+						calculateEigenVectors
+					);
+				}
+
+				for(
+					unsigned int n = 0;
+					n < chunkAccumulators[chunk].size();
+					n++
+				){
+					chunkAccumulators[chunk][n]->accumulate(
+						blockOffsets[block+1]
+						- blockOffsets[block],
+						blockEigenValues,
+						calculateEigenVectors
+							? hamiltonian
+							: nullptr
+					);
+				}
+			}
+		}
+		Profiler::Scope mergeScope("BlockSolver::mergeAccumulators");
+		for(
+			unsigned int chunk = 0;
+			chunk < chunkAccumulators.size();
+			chunk++
+		){
+			for(unsigned int n = 0; n < accumulators.size(); n++){
+				accumulators[n]->merge(
+					*chunkAccumulators[chunk][n]
+				);
+				delete chunkAccumulators[chunk][n];
+			}
+		}
+
+		mergeScope.stop();
+
+		//Store the results.
+		Profiler::Scope storeScope("BlockSolver::storeResults");
+		if(store != nullptr){
+			if(!isStored){
+				store->writeChunk(
+					batch,
+					batchEigenValues.data(),
+					batchEigenValues.size(),
+					hamiltonians.data(),
+					hamiltonians.size()
+				);
+			}
+		}
+		else if(storeResults){
+			copy(
+				batchEigenValues.begin(),
+				batchEigenValues.end(),
+				&eigenValues[blockOffsets[firstBlock]]
+			);
+			if(mode == Mode::EigenValuesAndEigenVectors){
+				copy(
+					hamiltonians.begin(),
+					hamiltonians.end(),
+					&eigenVectors[batchOffset]
+				);
+			}
+		}
+	}
+
+	//Evict old entries from the ResultCache once the size of the current
+	//entry is known.
+	if(cacheStore)
+		cache->finalizeEntry(key);
+}
+
+double BlockSolver::getEigenValue(
+	const Index &blockIndex,
+	unsigned int state
+) const{
+	TBTKAssert(
+		storeResults,
+		"BlockSolver::getEigenValue()",
+		"The results have not been stored.",
+		"Use BlockSolver::setStoreResults(true) to store the results."
+	);
+	int firstIndexInBlock = model->getHoppingAmplitudeSet(
+	).getFirstIndexInBlock(blockIndex);
+
+	return getEigenValue(firstIndexInBlock + state);
+}
+
+double BlockSolver::getEigenValue(unsigned int state) const{
+	BlockStore *store = getBlockStore();
+	if(store == nullptr)
+		return eigenValues[state];
+
+	//Page in the batch that contains the state. The lock is held until
+	//the value has been read, since the chunk can be evicted by the next
+	//call to getChunk().
+	unsigned int batch = getBlock(state)/BLOCKS_PER_BATCH;
+	lock_guard<mutex> lock(storeMutex);
+	const BlockStore::Chunk &chunk = store->getChunk(batch);
+
+	return chunk.eigenValues[
+		state - blockOffsets[batch*BLOCKS_PER_BATCH]
+	];
+}
+
+complex<double> BlockSolver::getAmplitude(
+	const Index &blockIndex,
+	unsigned int state,
+	const Index &index
+) const{
+	TBTKAssert(
+		storeResults,
+		"BlockSolver::getAmplitude()",
+		"The results have not been stored.",
+		"Use BlockSolver::setStoreResults(true) to store the results."
+	);
+	TBTKAssert(
+		mode == Mode::EigenValuesAndEigenVectors,
+		"BlockSolver::getAmplitude()",
+		"The eigenvectors have not been calculated.",
+		"Use BlockSolver::setMode(BlockSolver::Mode::EigenValuesAndEigenVectors)"
+		<< " to calculate the eigenvectors."
+	);
+
+	const HoppingAmplitudeSet &hoppingAmplitudeSet
+		= model->getHoppingAmplitudeSet();
+	unsigned int firstIndexInBlock
+		= hoppingAmplitudeSet.getFirstIndexInBlock(blockIndex);
+	unsigned int block = getBlock(firstIndexInBlock);
+	unsigned int blockSize = blockOffsets[block+1] - firstIndexInBlock;
+	unsigned int intraBlockIndex
+		= hoppingAmplitudeSet.getBasisIndex(index) - firstIndexInBlock;
+
+	BlockStore *store = getBlockStore();
+	if(store == nullptr){
+		return eigenVectors[
+			eigenVectorOffsets[block] + blockSize*state
+			+ intraBlockIndex
+		];
+	}
+
+	//Page in the batch that contains the block.
+	unsigned int batch = block/BLOCKS_PER_BATCH;
+	lock_guard<mutex> lock(storeMutex);
+	const BlockStore::Chunk &chunk = store->getChunk(batch);
+
+	return chunk.eigenVectors[
+		eigenVectorOffsets[block]
+		- eigenVectorOffsets[batch*BLOCKS_PER_BATCH]
+		+ blockSize*state + intraBlockIndex
+	];
+}
+
+unsigned long BlockSolver::calculateKey() const{
+	string configuration = "BlockSolver"
+		+ string(";mode=") + to_string((int)mode)
+		+ ";precision=" + to_string((int)precision)
+		+ ";blocksPerBatch=" + to_string(BLOCKS_PER_BATCH);
+
+	return ResultCache::calculateKey(
+		model->getHoppingAmplitudeSet(),
+		configuration
+	);
+}
+
+unsigned int BlockSolver::getBlock(unsigned int basisIndex) const{
+	return upper_bound(
+		blockOffsets.begin(),
+		blockOffsets.end(),
+		basisIndex
+	) - blockOffsets.begin() - 1;
+}
+
+void BlockSolver::solveBlock(
+	unsigned int block,
+	complex<double> *hamiltonian,
+	double *eigenValues,
+	bool calculateEigenVectors
+) const{
+	int blockSize = blockOffsets[block+1] - blockOffsets[block];
+	const char uplo = 'U';
+	int lwork = max(1, 2*blockSize - 1);
+	int info;
+
+	if(precision == Precision::Double){
+		const char jobz = calculateEigenVectors ? 'V' : 'N';
+		vector<complex<double>> work(lwork);
+		vector<double> rwork(max(1, 3*blockSize - 2));
+
+		zheev_(
+			&jobz,
+			&uplo,
+			&blockSize,
+			hamiltonian,
+			&blockSize,
+			eigenValues,
+			work.data(),
+			&lwork,
+			rwork.data(),
+			&info
+		);
+		TBTKAssert(
+			info == 0,
+			"BlockSolver::solveBlock()",
+			"Diagonalization of block " << block << " failed with"
+			<< " error code " << info << ".",
+			""
+		);
+
+		return;
+	}
+
+	//Diagonalize in single precision. The eigenvectors are always
+	//calculated in mixed precision since they are needed to refine the
+	//eigenvalues.
+	bool refine = precision == Precision::Mixed;
+	const char jobz = (calculateEigenVectors || refine) ? 'V' : 'N';
+	unsigned int matrixSize = blockSize*blockSize;
+	vector<complex<float>> singlePrecisionHamiltonian(matrixSize);
+	for(unsigned int n = 0; n < matrixSize; n++)
+		singlePrecisionHamiltonian[n] = complex<float>(hamiltonian[n]);
+	vector<float> singlePrecisionEigenValues(blockSize);
+	vector<complex<float>> work(lwork);
+	vector<float> rwork(max(1, 3*blockSize - 2));
+
+	cheev_(
+		&jobz,
+		&uplo,
+		&blockSize,
+		singlePrecisionHamiltonian.data(),
+		&blockSize,
+		singlePrecisionEigenValues.data(),
+		work.data(),
+		&lwork,
+		rwork.data(),
+		&info
+	);
+	TBTKAssert(
+		info == 0,
+		"BlockSolver::solveBlock()",
+		"Diagonalization of block " << block << " failed with error"
+		<< " code " << info << ".",
+		""
+	);
+
+	for(int n = 0; n < blockSize; n++)
+		eigenValues[n] = singlePrecisionEigenValues[n];
+
+	if(!refine){
+		if(calculateEigenVectors){
+			for(unsigned int n = 0; n < matrixSize; n++){
+				hamiltonian[n]
+					= singlePrecisionHamiltonian[n];
+			}
+		}
+
+		return;
+	}
+
+	//Refine the eigenvalues using the Rayleigh quotient
+	//<v|H|v>/<v|v> with the Hamiltonian in double precision. The error
+	//is quadratic in the error of the eigenvectors.
+	vector<complex<double>> doublePrecisionEigenVectors(
+		singlePrecisionHamiltonian.begin(),
+		singlePrecisionHamiltonian.end()
+	);
+	vector<complex<double>> product(matrixSize);
+	const char side = 'L';
+	const complex<double> one = 1;
+	const complex<double> zero = 0;
+	zhemm_(
+		&side,
+		&uplo,
+		&blockSize,
+		&blockSize,
+		&one,
+		hamiltonian,
+		&blockSize,
+		doublePrecisionEigenVectors.data(),
+		&blockSize,
+		&zero,
+		product.data(),
+		&blockSize
+	);
+	for(int state = 0; state < blockSize; state++){
+		double numerator = 0;
+		double denominator = 0;
+		for(int n = 0; n < blockSize; n++){
+			const complex<double> &amplitude
+				= doublePrecisionEigenVectors[blockSize*state + n];
+			numerator += real(
+				conj(amplitude)*product[blockSize*state + n]
+			);
+			denominator += norm(amplitude);
+		}
+		eigenValues[state] = numerator/denominator;
+	}
+
+	if(calculateEigenVectors)
+		copy(
+			doublePrecisionEigenVectors.begin(),
+			doublePrecisionEigenVectors.end(),
+			hamiltonian
+		);
+
+	//The refinement can change the order of nearly degenerate
+	//eigenvalues. Restore the order using insertion sort, which is
+	//linear for nearly sorted eigenvalues.
+	for(int state = 1; state < blockSize; state++){
+		for(
+			int n = state;
+			n > 0 && eigenValues[n] < eigenValues[n-1];
+			n--
+		){
+			swap(eigenValues[n], eigenValues[n-1]);
+			if(calculateEigenVectors){
+				swap_ranges(
+					hamiltonian + blockSize*n,
+					hamiltonian + blockSize*(n+1),
+					hamiltonian + blockSize*(n-1)
+				);
+			}
+		}
+	}
+}
@@ -0,0 +1,308 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file BlockStore.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "BlockStore.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <cerrno>
+#include <cstdio>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+//Identifies files written by the BlockStore.
+static const unsigned int MAGIC = 0x424C4B33;
+
+//Calculates a 64-bit FNV-1a checksum.
+static unsigned long calculateChecksum(
+	const void *data,
+	size_t size,
+	unsigned long checksum = 0xcbf29ce484222325
+){
+	const unsigned char *bytes = (const unsigned char*)data;
+	for(size_t n = 0; n < size; n++){
+		checksum ^= bytes[n];
+		checksum *= 0x100000001b3;
+	}
+
+	return checksum;
+}
+
+//Writes a file and flushes it to disk before it is closed.
+static void writeFile(
+	const string &filename,
+	const void *header,
+	size_t headerSize,
+	const void *data0,
+	size_t size0,
+	const void *data1,
+	size_t size1
+){
+	FILE *file = fopen(filename.c_str(), "wb");
+	TBTKAssert(
+		file != nullptr,
+		"BlockStore::writeFile()",
+		"Unable to open '" << filename << "' for writing.",
+		""
+	);
+	bool success = fwrite(header, 1, headerSize, file) == headerSize
+		&& fwrite(data0, 1, size0, file) == size0
+		&& fwrite(data1, 1, size1, file) == size1
+		&& fflush(file) == 0
+		&& fsync(fileno(file)) == 0;
+	fclose(file);
+	TBTKAssert(
+		success,
+		"BlockStore::writeFile()",
+		"Failed to write '" << filename << "'.",
+		""
+	);
+}
+
+BlockStore::BlockStore(const string &directory, unsigned int cacheSize){
+	TBTKAssert(
+		cacheSize > 0,
+		"BlockStore::BlockStore()",
+		"The cache size must be larger than zero.",
+		""
+	);
+
+	this->directory = directory;
+	this->cacheSize = cacheSize;
+	checkpoint = {MAGIC, 0, 0, 0, 0, 0};
+
+	//Create the directory and its parents.
+	for(size_t n = 1; n <= directory.size(); n++){
+		if(n == directory.size() || directory[n] == '/'){
+			string path = directory.substr(0, n);
+			TBTKAssert(
+				mkdir(path.c_str(), 0755) == 0
+				|| errno == EEXIST,
+				"BlockStore::BlockStore()",
+				"Unable to create the directory '" << path
+				<< "'.",
+				""
+			);
+		}
+	}
+}
+
+unsigned int BlockStore::open(
+	unsigned int numChunks,
+	unsigned int basisSize,
+	bool hasEigenVectors,
+	unsigned long key
+){
+	recentlyUsed.clear();
+	cache.clear();
+
+	//Resume from the stored checkpoint if it belongs to a calculation
+	//with the same parameters and key. The chunks themselves are not read
+	//here. Their checksums are verified when they are loaded by
+	//getChunk().
+	Checkpoint storedCheckpoint;
+	FILE *file = fopen((directory + "/checkpoint").c_str(), "rb");
+	if(file != nullptr){
+		bool success = fread(
+			&storedCheckpoint,
+			sizeof(storedCheckpoint),
+			1,
+			file
+		) == 1;
+		fclose(file);
+
+		if(
+			success
+			&& storedCheckpoint.magic == MAGIC
+			&& storedCheckpoint.numChunks == numChunks
+			&& storedCheckpoint.basisSize == basisSize
+			&& storedCheckpoint.hasEigenVectors == hasEigenVectors
+			&& storedCheckpoint.numStoredChunks <= numChunks
+			&& storedCheckpoint.key == key
+		){
+			checkpoint = storedCheckpoint;
+
+			return checkpoint.numStoredChunks;
+		}
+	}
+
+	//Start over.
+	checkpoint = {
+		MAGIC,
+		numChunks,
+		basisSize,
+		hasEigenVectors,
+		0,
+		key
+	};
+	writeCheckpoint();
+
+	return 0;
+}
+
+void BlockStore::writeChunk(
+	unsigned int chunk,
+	const double *eigenValues,
+	unsigned int numEigenValues,
+	const complex<double> *eigenVectors,
+	unsigned long numEigenVectorEntries
+){
+	TBTKAssert(
+		chunk == checkpoint.numStoredChunks,
+		"BlockStore::writeChunk()",
+		"Expected chunk " << checkpoint.numStoredChunks << ", but"
+		<< " received chunk " << chunk << ".",
+		"The chunks must be written in order."
+	);
+	if(!checkpoint.hasEigenVectors)
+		numEigenVectorEntries = 0;
+
+	unsigned long header[4] = {
+		MAGIC,
+		numEigenValues,
+		numEigenVectorEntries,
+		calculateChecksum(
+			eigenVectors,
+			numEigenVectorEntries*sizeof(complex<double>),
+			calculateChecksum(
+				eigenValues,
+				numEigenValues*sizeof(double)
+			)
+		)
+	};
+	writeFile(
+		getChunkFilename(chunk),
+		header,
+		sizeof(header),
+		eigenValues,
+		numEigenValues*sizeof(double),
+		eigenVectors,
+		numEigenVectorEntries*sizeof(complex<double>)
+	);
+
+	checkpoint.numStoredChunks++;
+	writeCheckpoint();
+}
+
+const BlockStore::Chunk& BlockStore::getChunk(unsigned int chunk){
+	TBTKAssert(
+		chunk < checkpoint.numStoredChunks,
+		"BlockStore::getChunk()",
+		"Chunk " << chunk << " has not been stored.",
+		""
+	);
+
+	//Move the chunk to the front if it is cached.
+	auto iterator = cache.find(chunk);
+	if(iterator != cache.end()){
+		recentlyUsed.splice(
+			recentlyUsed.begin(),
+			recentlyUsed,
+			iterator->second.second
+		);
+
+		return iterator->second.first;
+	}
+
+	//Evict the least recently used chunk if the cache is full.
+	if(cache.size() == cacheSize){
+		cache.erase(recentlyUsed.back());
+		recentlyUsed.pop_back();
+	}
+
+	//Read the chunk.
+	Chunk newChunk;
+	TBTKAssert(
+		readChunk(chunk, newChunk),
+		"BlockStore::getChunk()",
+		"The file '" << getChunkFilename(chunk) << "' is missing or"
+		<< " corrupt.",
+		"Remove the directory '" << directory << "' and rerun the"
+		<< " calculation."
+	);
+
+	recentlyUsed.push_front(chunk);
+	auto &entry = cache[chunk];
+	entry.first = std::move(newChunk);
+	entry.second = recentlyUsed.begin();
+
+	return entry.first;
+}
+
+bool BlockStore::readChunk(unsigned int chunk, Chunk &result) const{
+	FILE *file = fopen(getChunkFilename(chunk).c_str(), "rb");
+	if(file == nullptr)
+		return false;
+
+	unsigned long header[4];
+	bool success = fread(header, sizeof(header), 1, file) == 1
+		&& header[0] == MAGIC;
+	if(success){
+		result.eigenValues.resize(header[1]);
+		result.eigenVectors.resize(header[2]);
+		success = fread(
+			result.eigenValues.data(),
+			sizeof(double),
+			header[1],
+			file
+		) == header[1] && fread(
+			result.eigenVectors.data(),
+			sizeof(complex<double>),
+			header[2],
+			file
+		) == header[2];
+	}
+	fclose(file);
+
+	return success && header[3] == calculateChecksum(
+		result.eigenVectors.data(),
+		result.eigenVectors.size()*sizeof(complex<double>),
+		calculateChecksum(
+			result.eigenValues.data(),
+			result.eigenValues.size()*sizeof(double)
+		)
+	);
+}
+
+string BlockStore::getChunkFilename(unsigned int chunk) const{
+	return directory + "/chunk_" + to_string(chunk);
+}
+
+void BlockStore::writeCheckpoint() const{
+	string filename = directory + "/checkpoint";
+	writeFile(
+		filename + ".tmp",
+		&checkpoint,
+		sizeof(checkpoint),
+		nullptr,
+		0,
+		nullptr,
+		0
+	);
+	TBTKAssert(
+		rename((filename + ".tmp").c_str(), filename.c_str()) == 0,
+		"BlockStore::writeCheckpoint()",
+		"Unable to replace '" << filename << "'.",
+		""
+	);
+}
@@ -0,0 +1,68 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file DOSAccumulator.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "DOSAccumulator.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace TBTK;
+
+DOSAccumulator::DOSAccumulator(
+	double lowerBound,
+	double upperBound,
+	int energyResolution
+) :
+	counts(energyResolution, 0)
+{
+	this->lowerBound = lowerBound;
+	this->upperBound = upperBound;
+	this->energyResolution = energyResolution;
+}
+
+void DOSAccumulator::accumulate(
+	unsigned int blockSize,
+	const double *eigenValues,
+	const complex<double> *eigenVectors
+){
+	double dE = (upperBound - lowerBound)/energyResolution;
+	for(unsigned int n = 0; n < blockSize; n++){
+		int e = (int)floor((eigenValues[n] - lowerBound)/dE);
+		if(e >= 0 && e < energyResolution)
+			counts[e]++;
+	}
+}
+
+void DOSAccumulator::merge(const BlockAccumulator &blockAccumulator){
+	const DOSAccumulator &dosAccumulator
+		= (const DOSAccumulator&)blockAccumulator;
+	for(int e = 0; e < energyResolution; e++)
+		counts[e] += dosAccumulator.counts[e];
+}
+
+Property::DOS DOSAccumulator::getDOS() const{
+	Property::DOS dos(lowerBound, upperBound, energyResolution);
+	double dE = (upperBound - lowerBound)/energyResolution;
+	for(int e = 0; e < energyResolution; e++)
+		dos(e) = counts[e]/dE;
+
+	return dos;
+}
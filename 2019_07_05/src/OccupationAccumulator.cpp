@@ -0,0 +1,58 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file OccupationAccumulator.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "OccupationAccumulator.h"
+
+#include <cmath>
+
+using namespace std;
+
+OccupationAccumulator::OccupationAccumulator(
+	double chemicalPotential,
+	double kT
+){
+	this->chemicalPotential = chemicalPotential;
+	this->kT = kT;
+	occupation = 0;
+}
+
+void OccupationAccumulator::accumulate(
+	unsigned int blockSize,
+	const double *eigenValues,
+	const complex<double> *eigenVectors
+){
+	for(unsigned int n = 0; n < blockSize; n++){
+		if(kT == 0){
+			if(eigenValues[n] < chemicalPotential)
+				occupation += 1;
+		}
+		else{
+			occupation += 1/(
+				exp((eigenValues[n] - chemicalPotential)/kT)
+				+ 1
+			);
+		}
+	}
+}
+
+void OccupationAccumulator::merge(const BlockAccumulator &blockAccumulator){
+	occupation += ((const OccupationAccumulator&)blockAccumulator).occupation;
+}
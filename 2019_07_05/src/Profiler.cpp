@@ -0,0 +1,336 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file Profiler.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "Profiler.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <omp.h>
+#include <sys/resource.h>
+#include <time.h>
+
+using namespace std;
+
+//Environment variable that enables profiling.
+static const char *OUTPUT_VARIABLE = "PROFILER_OUTPUT";
+
+bool Profiler::enabled = getenv(OUTPUT_VARIABLE) != nullptr;
+
+namespace{
+
+//A recorded phase.
+class Event{
+public:
+	const char *name;
+	int thread;
+	double start;
+	double duration;
+	double cpuTime;
+	double threadCPUTime;
+	unsigned long numAllocations;
+	long processPeakRSS;
+};
+
+//Recorded phases.
+vector<Event> events;
+mutex eventsMutex;
+
+//Number of allocations made by a thread. The counters of all running threads
+//are kept in a linked list so that they can be summed to get the total for
+//the process. Neither the constructor nor the destructor allocates memory,
+//since they are called from operator new.
+class AllocationCounter{
+public:
+	atomic<unsigned long> numAllocations;
+	AllocationCounter *next;
+	AllocationCounter *previous;
+
+	AllocationCounter();
+	~AllocationCounter();
+};
+
+//The first counter in the list, the number of allocations made by threads
+//that have exited, and a mutex protecting both.
+AllocationCounter *allocationCounters = nullptr;
+unsigned long exitedThreadsNumAllocations = 0;
+mutex allocationCountersMutex;
+
+AllocationCounter::AllocationCounter() : numAllocations(0){
+	lock_guard<mutex> lock(allocationCountersMutex);
+	previous = nullptr;
+	next = allocationCounters;
+	if(next != nullptr)
+		next->previous = this;
+	allocationCounters = this;
+}
+
+AllocationCounter::~AllocationCounter(){
+	lock_guard<mutex> lock(allocationCountersMutex);
+	exitedThreadsNumAllocations += numAllocations.load(
+		memory_order_relaxed
+	);
+	if(previous == nullptr)
+		allocationCounters = next;
+	else
+		previous->next = next;
+	if(next != nullptr)
+		next->previous = previous;
+}
+
+//The counter for the current thread.
+thread_local AllocationCounter allocationCounter;
+
+//Total number of allocations made by all threads.
+unsigned long getTotalNumAllocations(){
+	lock_guard<mutex> lock(allocationCountersMutex);
+	unsigned long numAllocations = exitedThreadsNumAllocations;
+	for(
+		AllocationCounter *counter = allocationCounters;
+		counter != nullptr;
+		counter = counter->next
+	){
+		numAllocations += counter->numAllocations.load(
+			memory_order_relaxed
+		);
+	}
+
+	return numAllocations;
+}
+
+//Time at which the program started.
+const chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+//Wall time in microseconds since the program started.
+double getWallTime(){
+	return chrono::duration<double, micro>(
+		chrono::steady_clock::now() - startTime
+	).count();
+}
+
+//CPU time in microseconds for the given clock.
+double getCPUTime(clockid_t clock){
+	timespec time;
+	clock_gettime(clock, &time);
+
+	return time.tv_sec*1e6 + time.tv_nsec*1e-3;
+}
+
+//Peak resident set size in kB of the process since it started.
+long getProcessPeakRSS(){
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	return usage.ru_maxrss;
+}
+
+//Escapes a string for use in JSON.
+string escape(const char *str){
+	string result;
+	for(const char *c = str; *c != '\0'; c++){
+		if(*c == '"' || *c == '\\')
+			result += '\\';
+		result += *c;
+	}
+
+	return result;
+}
+
+}
+
+Profiler::Scope::Scope(const char *name){
+	if(!enabled){
+		this->name = nullptr;
+		return;
+	}
+
+	this->name = name;
+	wallTime = getWallTime();
+	cpuTime = getCPUTime(CLOCK_PROCESS_CPUTIME_ID);
+	threadCPUTime = getCPUTime(CLOCK_THREAD_CPUTIME_ID);
+	this->numAllocations = allocationCounter.numAllocations.load(
+		memory_order_relaxed
+	);
+}
+
+Profiler::Scope::~Scope(){
+	stop();
+}
+
+void Profiler::Scope::stop(){
+	if(name == nullptr)
+		return;
+
+	Event event;
+	event.name = name;
+	event.thread = omp_get_thread_num();
+	event.start = wallTime;
+	event.duration = getWallTime() - wallTime;
+	event.cpuTime = getCPUTime(CLOCK_PROCESS_CPUTIME_ID) - cpuTime;
+	event.threadCPUTime
+		= getCPUTime(CLOCK_THREAD_CPUTIME_ID) - threadCPUTime;
+	event.numAllocations = allocationCounter.numAllocations.load(
+		memory_order_relaxed
+	) - this->numAllocations;
+	event.processPeakRSS = getProcessPeakRSS();
+	name = nullptr;
+
+	lock_guard<mutex> lock(eventsMutex);
+	events.push_back(event);
+}
+
+string Profiler::getFilename(){
+	const char *filename = getenv(OUTPUT_VARIABLE);
+
+	return filename == nullptr ? "" : filename;
+}
+
+void Profiler::write(const string &filename){
+	lock_guard<mutex> lock(eventsMutex);
+
+	ofstream fout(filename);
+	TBTKAssert(
+		fout,
+		"Profiler::write()",
+		"Unable to open '" << filename << "'.",
+		""
+	);
+
+	//Write the phases as complete events. The utilization is the
+	//average number of busy cores during the phase. The times are written
+	//in microseconds with a fixed number of decimals, since the default
+	//six significant digits would quantize the timestamps of long runs.
+	fout << fixed << setprecision(3);
+	fout << "{\n\t\"traceEvents\": [";
+	for(unsigned int n = 0; n < events.size(); n++){
+		const Event &event = events[n];
+		fout << (n == 0 ? "\n" : ",\n")
+			<< "\t\t{\"name\": \"" << escape(event.name) << "\""
+			<< ", \"ph\": \"X\", \"pid\": 0"
+			<< ", \"tid\": " << event.thread
+			<< ", \"ts\": " << event.start
+			<< ", \"dur\": " << event.duration
+			<< ", \"args\": {"
+			<< "\"cpuTime\": " << event.cpuTime
+			<< ", \"threadCPUTime\": " << event.threadCPUTime
+			<< ", \"utilization\": " << (
+				event.duration > 0
+					? event.cpuTime/event.duration
+					: 0
+			)
+			<< ", \"allocations\": " << event.numAllocations
+			<< ", \"processPeakRSS\": " << event.processPeakRSS
+			<< "}}";
+	}
+	fout << "\n\t],\n";
+
+	//Write the total for each phase.
+	class Summary{
+	public:
+		unsigned int count;
+		double duration;
+		double cpuTime;
+		unsigned long numAllocations;
+		long processPeakRSS;
+	};
+	map<string, Summary> summaries;
+	for(unsigned int n = 0; n < events.size(); n++){
+		const Event &event = events[n];
+		map<string, Summary>::iterator iterator
+			= summaries.find(event.name);
+		if(iterator == summaries.end()){
+			summaries[event.name] = {
+				1,
+				event.duration,
+				event.cpuTime,
+				event.numAllocations,
+				event.processPeakRSS
+			};
+		}
+		else{
+			Summary &summary = iterator->second;
+			summary.count++;
+			summary.duration += event.duration;
+			summary.cpuTime += event.cpuTime;
+			summary.numAllocations += event.numAllocations;
+			if(summary.processPeakRSS < event.processPeakRSS)
+				summary.processPeakRSS = event.processPeakRSS;
+		}
+	}
+	fout << "\t\"displayTimeUnit\": \"ms\",\n\t\"phases\": {";
+	for(
+		map<string, Summary>::const_iterator iterator
+			= summaries.begin();
+		iterator != summaries.end();
+		++iterator
+	){
+		const Summary &summary = iterator->second;
+		fout << (iterator == summaries.begin() ? "\n" : ",\n")
+			<< "\t\t\"" << escape(iterator->first.c_str())
+			<< "\": {"
+			<< "\"count\": " << summary.count
+			<< ", \"duration\": " << summary.duration
+			<< ", \"cpuTime\": " << summary.cpuTime
+			<< ", \"allocations\": " << summary.numAllocations
+			<< ", \"processPeakRSS\": " << summary.processPeakRSS
+			<< "}";
+	}
+	fout << "\n\t},\n";
+
+	//Write the total number of allocations made by all threads.
+	fout << "\t\"allocations\": " << getTotalNumAllocations() << "\n}\n";
+}
+
+void Profiler::countAllocation(){
+	//Only the owning thread writes to the counter, so a relaxed load and
+	//store is enough and avoids a locked read-modify-write.
+	if(enabled){
+		allocationCounter.numAllocations.store(
+			allocationCounter.numAllocations.load(
+				memory_order_relaxed
+			) + 1,
+			memory_order_relaxed
+		);
+	}
+}
+
+//Replace the global operator new and delete to count the allocations. The
+//array and nothrow versions are implemented in terms of these by the standard
+//library.
+void* operator new(size_t size){
+	Profiler::countAllocation();
+	void *ptr = malloc(size == 0 ? 1 : size);
+	if(ptr == nullptr)
+		throw bad_alloc();
+
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept{
+	free(ptr);
+}
@@ -0,0 +1,95 @@
+/* Copyright 2019 Kristofer Björnson
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/** @file SpectralFunctionAccumulator.cpp
+ *
+ *  @author Kristofer Björnson
+ */
+
+#include "SpectralFunctionAccumulator.h"
+#include "TBTK/TBTKMacros.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace TBTK;
+
+SpectralFunctionAccumulator::SpectralFunctionAccumulator(
+	unsigned int numOrbitals,
+	double lowerBound,
+	double upperBound,
+	int energyResolution
+) :
+	spectralWeights(numOrbitals*energyResolution, 0)
+{
+	this->numOrbitals = numOrbitals;
+	this->lowerBound = lowerBound;
+	this->upperBound = upperBound;
+	this->energyResolution = energyResolution;
+}
+
+void SpectralFunctionAccumulator::accumulate(
+	unsigned int blockSize,
+	const double *eigenValues,
+	const complex<double> *eigenVectors
+){
+	TBTKAssert(
+		blockSize == numOrbitals,
+		"SpectralFunctionAccumulator::accumulate()",
+		"Encountered a block of size " << blockSize << ", but expected"
+		<< " " << numOrbitals << " orbitals.",
+		""
+	);
+
+	double dE = (upperBound - lowerBound)/energyResolution;
+	for(unsigned int n = 0; n < blockSize; n++){
+		int e = (int)floor((eigenValues[n] - lowerBound)/dE);
+		if(e < 0 || e >= energyResolution)
+			continue;
+
+		for(unsigned int orbital = 0; orbital < numOrbitals; orbital++){
+			spectralWeights[energyResolution*orbital + e] += norm(
+				eigenVectors[blockSize*n + orbital]
+			);
+		}
+	}
+}
+
+void SpectralFunctionAccumulator::merge(
+	const BlockAccumulator &blockAccumulator
+){
+	const SpectralFunctionAccumulator &spectralFunctionAccumulator
+		= (const SpectralFunctionAccumulator&)blockAccumulator;
+	for(unsigned int n = 0; n < spectralWeights.size(); n++){
+		spectralWeights[n]
+			+= spectralFunctionAccumulator.spectralWeights[n];
+	}
+}
+
+Array<double> SpectralFunctionAccumulator::getSpectralFunction() const{
+	Array<double> spectralFunction(
+		{numOrbitals, (unsigned int)energyResolution}
+	);
+	double dE = (upperBound - lowerBound)/energyResolution;
+	for(unsigned int orbital = 0; orbital < numOrbitals; orbital++){
+		for(unsigned int e = 0; e < (unsigned int)energyResolution; e++){
+			spectralFunction[{orbital, e}]
+				= spectralWeights[energyResolution*orbital + e]/dE;
+		}
+	}
+
+	return spectralFunction;
+}
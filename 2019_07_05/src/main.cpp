@@ -13,29 +13,130 @@
  * limitations under the License.
  */
 
+#include "BlockSolver.h"
+#include "DOSAccumulator.h"
+#include "Profiler.h"
+#include "ResultCache.h"
 #include "TBTK/BrillouinZone.h"
 #include "TBTK/Model.h"
 #include "TBTK/Property/DOS.h"
-#include "TBTK/PropertyExtractor/BlockDiagonalizer.h"
 #include "TBTK/Range.h"
 #include "TBTK/Smooth.h"
-#include "TBTK/Solver/BlockDiagonalizer.h"
 #include "TBTK/Streams.h"
 #include "TBTK/TBTK.h"
 #include "TBTK/UnitHandler.h"
 #include "TBTK/Vector3d.h"
 #include "TBTK/Visualization/MatPlotLib/Plotter.h"
 
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <memory>
+
+#include <omp.h>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
 using namespace std;
 using namespace TBTK;
 using namespace Visualization::MatPlotLib;
 
 complex<double> i(0, 1);
 
+//Returns the rank of the current process.
+int getRank(){
+#ifdef USE_MPI
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	return rank;
+#else
+	return 0;
+#endif
+}
+
+//Returns the number of processes.
+int getNumRanks(){
+#ifdef USE_MPI
+	int numRanks;
+	MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+	return numRanks;
+#else
+	return 1;
+#endif
+}
+
+//Returns true if the current process is responsible for the block with the
+//given k-index. The blocks are distributed over the processes in slabs along
+//the first k-index.
+bool isLocal(const Index &kIndex, unsigned int size){
+	unsigned int begin = (size*getRank())/getNumRanks();
+	unsigned int end = (size*(getRank() + 1))/getNumRanks();
+
+	return (unsigned int)kIndex[0] >= begin
+		&& (unsigned int)kIndex[0] < end;
+}
+
+//Sums the DOS over all processes.
+void reduce(Property::DOS &dos){
+#ifdef USE_MPI
+	vector<double> buffer(dos.getResolution());
+	for(unsigned int c = 0; c < dos.getResolution(); c++)
+		buffer[c] = dos(c);
+	MPI_Allreduce(
+		MPI_IN_PLACE,
+		buffer.data(),
+		buffer.size(),
+		MPI_DOUBLE,
+		MPI_SUM,
+		MPI_COMM_WORLD
+	);
+	for(unsigned int c = 0; c < dos.getResolution(); c++)
+		dos(c) = buffer[c];
+#endif
+}
+
+//Returns the number of threads passed as an argument. Prints a usage message
+//and exits if it is not a positive integer.
+int parseNumThreads(const char *argument){
+	char *end;
+	errno = 0;
+	long numThreads = strtol(argument, &end, 10);
+	if(
+		end == argument || *end != '\0' || errno != 0
+		|| numThreads < 1 || numThreads > INT_MAX
+	){
+		if(getRank() == 0){
+			Streams::out << "Error: The number of threads must be a"
+				<< " positive integer, but '" << argument
+				<< "' was given.\n"
+				<< "Usage: Application [numThreads] [blockDirectory]\n";
+		}
+#ifdef USE_MPI
+		MPI_Finalize();
+#endif
+		exit(1);
+	}
+
+	return numThreads;
+}
+
 int main(int argc, char **argv){
+#ifdef USE_MPI
+	//Initialize MPI.
+	MPI_Init(&argc, &argv);
+#endif
+
 	//Initialize TBTK.
 	Initialize();
 
+	//Set the number of threads to solve the blocks with. All available
+	//cores are used unless the number of threads is passed as the first
+	//argument.
+	if(argc > 1)
+		omp_set_num_threads(parseNumThreads(argv[1]));
+
 	//Set the natural units for this calculation.
 	UnitHandler::setScales(
 		{"1 rad", "1 C", "1 pcs", "1 eV", "1 Ao", "1 K", "1 s"}
@@ -77,6 +178,16 @@ int main(int argc, char **argv){
 		);
 	}
 
+	//Function that calculates the matrix element between the A and B site
+	//at a given k-point.
+	auto calculateH01 = [&](const Vector3d &k){
+		return -t*(
+			exp(-i*Vector3d::dotProduct(k, r_AB[0]))
+			+ exp(-i*Vector3d::dotProduct(k, r_AB[1]))
+			+ exp(-i*Vector3d::dotProduct(k, r_AB[2]))
+		);
+	};
+
 	//Setup the BrillouinZone.
 	BrillouinZone brillouinZone(
 		{
@@ -87,11 +198,15 @@ int main(int argc, char **argv){
 	);
 
 	//Create mesh.
+	Profiler::Scope meshScope("Create mesh");
 	vector<vector<double>> mesh = brillouinZone.getMinorMesh(
 		numMeshPoints
 	);
 
+	meshScope.stop();
+
 	//Setup model.
+	Profiler::Scope modelScope("Setup model");
 	Model model;
 	for(unsigned int n = 0; n < mesh.size(); n++){
 		//Get the Index representation of the current k-point.
@@ -100,12 +215,13 @@ int main(int argc, char **argv){
 			numMeshPoints
 		);
 
+		//Only add the k-points that this process is responsible for.
+		if(!isLocal(kIndex, BRILLOUIN_ZONE_RESOLUTION))
+			continue;
+
 		//Calculate the matrix element.
-		Vector3d k({mesh[n][0], mesh[n][1], 0});
-		complex<double> h_01 = -t*(
-			exp(-i*Vector3d::dotProduct(k, r_AB[0]))
-			+ exp(-i*Vector3d::dotProduct(k, r_AB[1]))
-			+ exp(-i*Vector3d::dotProduct(k, r_AB[2]))
+		complex<double> h_01 = calculateH01(
+			Vector3d({mesh[n][0], mesh[n][1], 0})
 		);
 
 		//Add the matrix element to the model.
@@ -115,33 +231,79 @@ int main(int argc, char **argv){
 			{kIndex[0], kIndex[1], 1}
 		) + HC;
 	}
+	modelScope.stop();
+	Profiler::Scope constructScope("Construct model");
 	model.construct();
+	constructScope.stop();
 
-	//Setup the solver.
-	Solver::BlockDiagonalizer solver;
-	solver.setModel(model);
-	solver.run();
-
-	//Setup the property extractor.
-	PropertyExtractor::BlockDiagonalizer propertyExtractor(solver);
-	propertyExtractor.setEnergyWindow(
+	//Setup the solver. The eigenvalues of each block are accumulated into
+	//the DOS directly after the block has been solved and are then
+	//discarded. Single precision is enough to resolve the eigenvalues on
+	//the energy grid.
+	DOSAccumulator dosAccumulator(
 		ENERGY_LOWER_BOUND,
 		ENERGY_UPPER_BOUND,
 		ENERGY_RESOLUTION
 	);
+	BlockSolver solver;
+	solver.setModel(model);
+	solver.setMode(BlockSolver::Mode::EigenValues);
+	solver.setPrecision(BlockSolver::Precision::Single);
+	solver.setStoreResults(false);
+	solver.addAccumulator(dosAccumulator);
 
-	//Calculate the density of states.
-	Property::DOS dos = propertyExtractor.calculateDOS();
+	//Store the eigenvalues out of core if a directory is passed as the
+	//second argument. If the calculation is interrupted, it is resumed
+	//from the last checkpoint the next time it is started.
+	unique_ptr<BlockStore> blockStore;
+	if(argc > 2){
+		string directory = argv[2];
+		if(getNumRanks() > 1)
+			directory += "/" + to_string(getRank());
+		blockStore.reset(new BlockStore(directory));
+		solver.setStoreResults(true);
+		solver.setBlockStore(*blockStore);
+	}
+
+	//Cache the results in the directory given by the environment
+	//variable RESULT_CACHE. If the Model has been solved before, the DOS
+	//is then accumulated from the cached eigenvalues instead of solving
+	//the Model again. Not used if a BlockStore has been set.
+	unique_ptr<ResultCache> cache;
+	if(getenv("RESULT_CACHE") != nullptr){
+		string directory = getenv("RESULT_CACHE");
+		if(getNumRanks() > 1)
+			directory += "/" + to_string(getRank());
+		cache.reset(new ResultCache(directory));
+		solver.setCache(*cache);
+	}
+	Profiler::Scope solveScope("Solve");
+	solver.run();
+	solveScope.stop();
+
+	//Get the density of states.
+	Property::DOS dos = dosAccumulator.getDOS();
+
+	//Sum the contributions from all processes.
+	Profiler::Scope reduceScope("Reduce DOS");
+	reduce(dos);
+	reduceScope.stop();
 
 	//Smooth the DOS.
 	const double SMOOTHING_SIGMA = 0.03;
 	const unsigned int SMOOTHING_WINDOW = 51;
+	Profiler::Scope smoothScope("Smooth DOS");
 	dos = Smooth::gaussian(dos, SMOOTHING_SIGMA, SMOOTHING_WINDOW);
+	smoothScope.stop();
 
 	//Plot the DOS.
+	Profiler::Scope plotScope("Plot DOS");
 	Plotter plotter;
-	plotter.plot(dos);
-	plotter.save("figures/DOS.png");
+	if(getRank() == 0){
+		plotter.plot(dos);
+		plotter.save("figures/DOS.png");
+	}
+	plotScope.stop();
 
 	//Define high symmetry points.
 	Vector3d Gamma({0,		0,			0});
@@ -155,8 +317,11 @@ int main(int argc, char **argv){
 		{K, Gamma}
 	};
 
-	//Calculate the band structure along the path Gamma -> M -> K -> Gamma.
-	Array<double> bandStructure({2, 3*K_POINTS_PER_PATH}, 0);
+	//Setup a model for the k-points along the path Gamma -> M -> K ->
+	//Gamma. Since the eigenvalues of the mesh are not stored, the k-points
+	//along the path are solved separately.
+	Profiler::Scope bandStructureScope("Calculate band structure");
+	Model pathModel;
 	Range interpolator(0, 1, K_POINTS_PER_PATH);
 	for(unsigned int p = 0; p < 3; p++){
 		//Select the start and end points for the current path.
@@ -164,24 +329,38 @@ int main(int argc, char **argv){
 		Vector3d endPoint = paths[p][1];
 
 		//Loop over a single path.
-		for(unsigned int n = 0; n < K_POINTS_PER_PATH; n++){
+		for(int n = 0; n < K_POINTS_PER_PATH; n++){
 			//Interpolate between the paths start and end point.
 			Vector3d k = (
 				interpolator[n]*endPoint
 				+ (1 - interpolator[n])*startPoint
 			);
 
-			//Get the Index representation of the current k-point.
-			Index kIndex = brillouinZone.getMinorCellIndex(
-				{k.x, k.y},
-				numMeshPoints
-			);
-
-			//Extract the eigenvalues for the current k-point.
-			bandStructure[{0, n+p*K_POINTS_PER_PATH}] = propertyExtractor.getEigenValue(kIndex, 0);
-			bandStructure[{1, n+p*K_POINTS_PER_PATH}] = propertyExtractor.getEigenValue(kIndex, 1);
+			//Add the matrix element to the model.
+			int pathPoint = n + p*K_POINTS_PER_PATH;
+			pathModel << HoppingAmplitude(
+				calculateH01(k),
+				{pathPoint, 0},
+				{pathPoint, 1}
+			) + HC;
 		}
 	}
+	pathModel.construct();
+
+	//Solve the k-points along the path.
+	BlockSolver pathSolver;
+	pathSolver.setModel(pathModel);
+	pathSolver.setMode(BlockSolver::Mode::EigenValues);
+	pathSolver.run();
+
+	//Extract the band structure.
+	Array<double> bandStructure({2, 3*K_POINTS_PER_PATH}, 0);
+	for(unsigned int n = 0; n < 3*K_POINTS_PER_PATH; n++){
+		bandStructure[{0, n}] = pathSolver.getEigenValue({n}, 0);
+		bandStructure[{1, n}] = pathSolver.getEigenValue({n}, 1);
+	}
+
+	bandStructureScope.stop();
 
 	//Find max and min value for the band structure.
 	double min = bandStructure[{0, 0}];
@@ -194,22 +373,40 @@ int main(int argc, char **argv){
 	}
 
 	//Plot the band structure.
-	plotter.clear();
-	plotter.setLabelX("k");
-	plotter.setLabelY("Energy");
-	plotter.plot(bandStructure.getSlice({0, _a_}), {{"color", "black"}});
-	plotter.plot(bandStructure.getSlice({1, _a_}), {{"color", "black"}});
-	plotter.plot(
-		{K_POINTS_PER_PATH, K_POINTS_PER_PATH},
-		{min, max},
-		{{"color", "black"}}
-	);
-	plotter.plot(
-		{2*K_POINTS_PER_PATH, 2*K_POINTS_PER_PATH},
-		{min, max},
-		{{"color", "black"}}
-	);
-	plotter.save("figures/BandStructure.png");
+	Profiler::Scope plotBandStructureScope("Plot band structure");
+	if(getRank() == 0){
+		plotter.clear();
+		plotter.setLabelX("k");
+		plotter.setLabelY("Energy");
+		plotter.plot(bandStructure.getSlice({0, _a_}), {{"color", "black"}});
+		plotter.plot(bandStructure.getSlice({1, _a_}), {{"color", "black"}});
+		plotter.plot(
+			{K_POINTS_PER_PATH, K_POINTS_PER_PATH},
+			{min, max},
+			{{"color", "black"}}
+		);
+		plotter.plot(
+			{2*K_POINTS_PER_PATH, 2*K_POINTS_PER_PATH},
+			{min, max},
+			{{"color", "black"}}
+		);
+		plotter.save("figures/BandStructure.png");
+	}
+	plotBandStructureScope.stop();
+
+	//Write the profiling results if profiling is enabled. Each process
+	//writes to its own file.
+	if(Profiler::isEnabled()){
+		string filename = Profiler::getFilename();
+		if(getNumRanks() > 1)
+			filename += "." + to_string(getRank());
+		Profiler::write(filename);
+	}
+
+#ifdef USE_MPI
+	//Finalize MPI.
+	MPI_Finalize();
+#endif
 
 	return 0;
 }